@@ -9,11 +9,27 @@
 
 #ifndef _FAREWELL_TO_KING_H_
 #define _FAREWELL_TO_KING_H_
+#include "farewell_to_king_alloc.h"
+#include "farewell_to_king_attack.h"
 #include "farewell_to_king_bitops.h"
 #include "farewell_to_king_board.h"
+#include "farewell_to_king_hash.h"
+#include "farewell_to_king_iterator.h"
 #include "farewell_to_king_mask.h"
 #include "farewell_to_king_types.h"
 
+/**
+ * @brief Number of types a Pawn may promote to
+ * 
+ */
+#define FTK_NUM_PROMOTIONS 4
+
+/**
+ * @brief Promotion types in the order moves are generated, Queen first
+ * 
+ */
+extern const ftk_type_e ftk_promotion_types[FTK_NUM_PROMOTIONS];
+
 /**
  * @brief Returns name string for Farewell to King Library
  * 
@@ -35,6 +51,22 @@ const char * ftk_get_name_ver_string();
  */
 const char * ftk_get_intro_string();
 
+/**
+ * @brief Allocates a game aligned to FTK_BOARD_ALIGNMENT, uninitialized
+ * 
+ * @param allocator allocator to use, NULL for default allocator
+ * @return ftk_game_s* NULL on failure
+ */
+ftk_game_s * ftk_new_game(const ftk_allocator_s *allocator);
+
+/**
+ * @brief Frees a game from ftk_new_game()
+ * 
+ * @param game game to free, may be NULL
+ * @param allocator allocator game came from, NULL for default allocator
+ */
+void ftk_delete_game(ftk_game_s *game, const ftk_allocator_s *allocator);
+
 /**
  * @brief Begins a standard game of chess
  * 
@@ -43,14 +75,52 @@ const char * ftk_get_intro_string();
 void ftk_begin_standard_game(ftk_game_s *game);
 
 /**
- * @brief Updates all board bitmasks for a game
+ * @brief Copies the position of a game (board, turn, en passant, castling rights, move counters and hash) without its move masks
+ * 
+ * @param dest game to copy position to, its masks are marked out of date
+ * @param src game to copy position from
+ */
+void ftk_copy_game_position(ftk_game_s *dest, const ftk_game_s *src);
+
+/**
+ * @brief Builds all move and attack masks of a game into caller provided memory, the game is not modified
+ * 
+ * @param game game to generate masks for
+ * @param masks output masks, e.g. scratch space of a game built with FTK_LEAN_BOARD
+ */
+void ftk_build_move_masks(const ftk_game_s *game, ftk_move_masks_s *masks);
+
+/**
+ * @brief Updates all board bitmasks for a game (No-op with FTK_LEAN_BOARD, games store no move masks)
  * 
  * @param game game to generate masks for
  */
 void ftk_update_board_masks(ftk_game_s *game);
 
 /**
- * @brief Stages a move in a game without modifying the game
+ * @brief Gets the legal move mask of a single square, building only that square if masks are not up to date.
+ *        Use after ftk_move_piece_quick() to validate a move without ftk_update_board_masks().
+ *        Built on every call with FTK_LEAN_BOARD
+ * 
+ * @param game game to get move mask from
+ * @param position position to get move mask for
+ * @return ftk_board_mask_t 
+ */
+ftk_board_mask_t ftk_get_move_mask(ftk_game_s *game, ftk_position_t position);
+
+/**
+ * @brief Checks if a single move is legal without building any move masks (Masks not required, used if up to date)
+ * 
+ * @param game game to check move in
+ * @param source position of piece to move
+ * @param target position to move piece to
+ * @param pawn_promotion promotion type (Queen if FTK_TYPE_EMPTY or FTK_TYPE_DONT_CARE), must be one of those if move is not a promotion
+ * @return true if move is legal for the current turn's player
+ */
+bool ftk_is_legal_move(const ftk_game_s *game, ftk_position_t source, ftk_position_t target, ftk_type_e pawn_promotion);
+
+/**
+ * @brief Stages a move in a game without modifying the game (Move mask of source must be up to date, see ftk_get_move_mask())
  * 
  * @param game Game to move in
  * @param target Position to move piece to
@@ -72,7 +142,7 @@ ftk_move_s ftk_stage_move(const ftk_game_s *game, ftk_position_t target, ftk_pos
 ftk_move_s ftk_move_piece(ftk_game_s *game, ftk_position_t target, ftk_position_t source, ftk_type_e pawn_promotion);
 
 /**
- * @brief Make a move in a game without generating masks (Masks must be generated via ftk_update_board_masks() before use)
+ * @brief Make a move in a game without generating masks (Masks must be generated via ftk_update_board_masks() or ftk_get_move_mask() before use)
  * 
  * @param game Game to move in
  * @param target Position to move piece to
@@ -119,7 +189,7 @@ ftk_result_e ftk_move_backward(ftk_game_s *game, ftk_move_s *move);
 ftk_result_e ftk_move_backward_quick(ftk_game_s *game, ftk_move_s *move);
 
 /**
- * @brief Checks if current turn's player is in check
+ * @brief Checks if current turn's player is in check (Does not require masks to be up to date)
  * 
  * @param game 
  * @return ftk_check_e 
@@ -127,7 +197,7 @@ ftk_result_e ftk_move_backward_quick(ftk_game_s *game, ftk_move_s *move);
 ftk_check_e ftk_check_for_check(const ftk_game_s *game);
 
 /**
- * @brief Checks if current player has any legal moves
+ * @brief Checks if current player has any legal moves (Masks used if up to date, otherwise stops at the first legal move found)
  * 
  * @param game 
  * @return true 
@@ -136,7 +206,7 @@ ftk_check_e ftk_check_for_check(const ftk_game_s *game);
 bool ftk_check_legal_moves(const ftk_game_s *game);
 
 /**
- * @brief Checks if a game end condition has been met
+ * @brief Checks if a game end condition has been met (Masks not required)
  * 
  * @param game 
  * @return ftk_game_end_e 
@@ -144,20 +214,78 @@ bool ftk_check_legal_moves(const ftk_game_s *game);
 ftk_game_end_e ftk_check_for_game_end(const ftk_game_s *game);
 
 /**
- * @brief Get list of legal moves for given game
+ * @brief Generate legal moves for given game into caller provided memory, no heap allocation
+ * 
+ * @param game game to generate moves for (Masks must be up to date, built per piece with FTK_LEAN_BOARD)
+ * @param buffer output moves, may be NULL if capacity is 0
+ * @param capacity number of moves buffer can hold, FTK_MAX_MOVES holds any position
+ * @return size_t number of legal moves, moves beyond capacity are counted but not written
+ */
+size_t ftk_generate_moves(const ftk_game_s *game, ftk_move_s *buffer, size_t capacity);
+
+/**
+ * @brief Generate one category of legal moves into caller provided memory, other categories are not examined (Masks not required)
+ * 
+ * @param game game to generate moves for
+ * @param mode category of moves to generate
+ * @param buffer output moves, may be NULL if capacity is 0
+ * @param capacity number of moves buffer can hold
+ * @return size_t number of moves in category, moves beyond capacity are counted but not written
+ */
+size_t ftk_generate_moves_by_mode(const ftk_game_s *game, ftk_gen_mode_e mode, ftk_move16_t *buffer, size_t capacity);
+
+/**
+ * @brief Generate pseudo-legal moves into caller provided memory, moves may leave the King in check (Masks not required).
+ *        Castling is only generated when legal.  Test moves with ftk_move_is_legal_after_pseudo() before making them
+ * 
+ * @param game game to generate moves for
+ * @param buffer output moves, may be NULL if capacity is 0
+ * @param capacity number of moves buffer can hold, FTK_MAX_MOVES holds any position
+ * @return size_t number of pseudo-legal moves, moves beyond capacity are counted but not written
+ */
+size_t ftk_generate_pseudo_legal_moves(const ftk_game_s *game, ftk_move16_t *buffer, size_t capacity);
+
+/**
+ * @brief Checks if a pseudo-legal move leaves the moving player's King unattacked (Masks not required)
+ * 
+ * @param game game before move is made
+ * @param move16 move from ftk_generate_pseudo_legal_moves()
+ * @return true if move is legal
+ */
+bool ftk_move_is_legal_after_pseudo(const ftk_game_s *game, ftk_move16_t move16);
+
+/**
+ * @brief Get list of legal moves for given game (Allocating wrapper of ftk_generate_moves())
  * 
  * @param game game to generate list for
- * @param move_list list of legal moves (memory allocated accordingly)
+ * @param move_list list of legal moves (memory allocated with ftk_alloc(), empty if allocation fails)
  */
 void ftk_get_move_list(const ftk_game_s *game, ftk_move_list_s * move_list);
 
+/**
+ * @brief Get list of legal moves for given game using given allocator, safe to call concurrently with own allocators
+ * 
+ * @param game game to generate list for
+ * @param move_list list of legal moves (memory allocated with ftk_alloc_with(), empty if allocation fails)
+ * @param allocator allocator to use, NULL for default allocator
+ */
+void ftk_get_move_list_with(const ftk_game_s *game, ftk_move_list_s * move_list, const ftk_allocator_s *allocator);
+
 /**
  * @brief Delete move list
  * 
- * @param move_list list of legal moves to delete (memory deallocated accordingly)
+ * @param move_list list of legal moves to delete (memory deallocated with ftk_free())
  */
 void ftk_delete_move_list(ftk_move_list_s * move_list);
 
+/**
+ * @brief Delete move list from ftk_get_move_list_with()
+ * 
+ * @param move_list list of legal moves to delete
+ * @param allocator allocator list was created with, NULL for default allocator
+ */
+void ftk_delete_move_list_with(ftk_move_list_s * move_list, const ftk_allocator_s *allocator);
+
 /**
  * @brief Invalidates move structure
  * 
@@ -165,4 +293,59 @@ void ftk_delete_move_list(ftk_move_list_s * move_list);
  */
 void ftk_invalidate_move(ftk_move_s *move);
 
+/**
+ * @brief Converts move structure to compact move
+ * 
+ * @param move Move to convert
+ * @return ftk_move16_t FTK_MOVE16_INVALID if move is not valid
+ */
+ftk_move16_t ftk_move_to_move16(const ftk_move_s *move);
+
+/**
+ * @brief Extracts state needed to undo a move from move structure
+ * 
+ * @param move Move to convert
+ * @param undo Output undo record
+ */
+void ftk_move_to_undo(const ftk_move_s *move, ftk_undo_s *undo);
+
+/**
+ * @brief Rebuilds move structure from compact move and its undo record
+ * 
+ * @param move16 Compact move
+ * @param undo Undo record saved when move was made
+ * @return ftk_move_s 
+ */
+ftk_move_s ftk_move16_to_move(ftk_move16_t move16, const ftk_undo_s *undo);
+
+/**
+ * @brief Move forward based on compact move without generating masks (Masks must be generated via ftk_update_board_masks() before use)
+ *
+ * @param game game to manipulate
+ * @param move16 move to make
+ * @param undo Output undo record for ftk_move16_backward_quick()
+ * @return ftk_result_e 
+ */
+ftk_result_e ftk_move16_forward_quick(ftk_game_s *game, ftk_move16_t move16, ftk_undo_s *undo);
+
+/**
+ * @brief Move backward based on compact move without generating masks (Masks must be generated via ftk_update_board_masks() before use)
+ *
+ * @param game game to manipulate
+ * @param move16 move to be reversed
+ * @param undo Undo record saved by ftk_move16_forward_quick()
+ * @return ftk_result_e 
+ */
+ftk_result_e ftk_move16_backward_quick(ftk_game_s *game, ftk_move16_t move16, const ftk_undo_s *undo);
+
+/**
+ * @brief Makes a move into a copy of the position, parent is never modified so no undo is needed (Masks not required)
+ *
+ * @param parent position to move from, may be shared by other readers
+ * @param move16 move to make
+ * @param child output position (Caller provided, typically on the stack), its masks are marked out of date
+ * @return ftk_result_e FTK_FAILURE if the move is invalid, child then holds an unmodified copy of parent
+ */
+ftk_result_e ftk_position_make_copy(const ftk_game_s *parent, ftk_move16_t move16, ftk_game_s *child);
+
 #endif // _FAREWELL_TO_KING_H_
\ No newline at end of file
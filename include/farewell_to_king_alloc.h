@@ -0,0 +1,103 @@
+/*
+ farewell_to_king_alloc.h
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains declarations of the allocator hooks and bundled bump arena.
+*/
+
+#ifndef _FAREWELL_TO_KING_ALLOC_H_
+#define _FAREWELL_TO_KING_ALLOC_H_
+#include "farewell_to_king_types.h"
+
+/**
+ * @brief Address alignment of every arena allocation
+ * 
+ */
+#define FTK_ARENA_ALIGNMENT 16
+
+/**
+ * @brief Sets process wide default allocator used when no allocator is passed.  Not thread safe, set once at
+ *        startup and free all library memory (e.g. move lists) before changing it.  Pass an allocator to the
+ *        *_with() functions instead for per thread or per request allocators (e.g. one arena per request)
+ * 
+ * @param allocator allocator to copy, NULL restores malloc/free
+ */
+void ftk_set_allocator(const ftk_allocator_s *allocator);
+
+/**
+ * @brief Allocates memory from current allocator
+ * 
+ * @param size number of bytes
+ * @return void* NULL on failure
+ */
+void * ftk_alloc(size_t size);
+
+/**
+ * @brief Frees memory to current allocator
+ * 
+ * @param ptr memory from ftk_alloc(), may be NULL
+ */
+void ftk_free(void *ptr);
+
+/**
+ * @brief Allocates memory from given allocator
+ * 
+ * @param allocator allocator to use, NULL for default allocator
+ * @param size number of bytes
+ * @return void* NULL on failure
+ */
+void * ftk_alloc_with(const ftk_allocator_s *allocator, size_t size);
+
+/**
+ * @brief Frees memory to given allocator
+ * 
+ * @param allocator allocator memory came from, NULL for default allocator
+ * @param ptr memory from ftk_alloc_with(), may be NULL
+ */
+void ftk_free_with(const ftk_allocator_s *allocator, void *ptr);
+
+/**
+ * @brief Allocates memory aligned beyond what the allocator guarantees, e.g. FTK_BOARD_ALIGNMENT
+ * 
+ * @param allocator allocator to use, NULL for default allocator
+ * @param size number of bytes
+ * @param alignment power of two alignment in bytes
+ * @return void* NULL on failure
+ */
+void * ftk_alloc_aligned_with(const ftk_allocator_s *allocator, size_t size, size_t alignment);
+
+/**
+ * @brief Frees memory from ftk_alloc_aligned_with()
+ * 
+ * @param allocator allocator memory came from, NULL for default allocator
+ * @param ptr memory from ftk_alloc_aligned_with(), may be NULL
+ */
+void ftk_free_aligned_with(const ftk_allocator_s *allocator, void *ptr);
+
+/**
+ * @brief Initializes arena over caller provided memory
+ * 
+ * @param arena arena to initialize
+ * @param buffer memory to allocate from
+ * @param size size of buffer in bytes
+ */
+void ftk_arena_init(ftk_arena_s *arena, void *buffer, size_t size);
+
+/**
+ * @brief Releases every allocation of arena at once
+ * 
+ * @param arena arena to reset
+ */
+void ftk_arena_reset(ftk_arena_s *arena);
+
+/**
+ * @brief Builds allocator allocating from arena, pass to the *_with() functions or ftk_set_allocator()
+ * 
+ * @param arena arena to allocate from, must outlive allocator use
+ * @param allocator output allocator
+ */
+void ftk_arena_allocator(ftk_arena_s *arena, ftk_allocator_s *allocator);
+
+#endif //_FAREWELL_TO_KING_ALLOC_H_
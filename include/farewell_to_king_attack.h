@@ -0,0 +1,84 @@
+/*
+ farewell_to_king_attack.h
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains declarations of precomputed attack table lookups.
+*/
+
+#ifndef _FAREWELL_TO_KING_ATTACK_H_
+#define _FAREWELL_TO_KING_ATTACK_H_
+#include "farewell_to_king_types.h"
+
+/**
+ * @brief Get squares attacked by a Bishop, including the first blocking square of each ray
+ *
+ * @param position Position of the Bishop
+ * @param occupied Mask of all occupied squares
+ * @return ftk_board_mask_t
+ */
+ftk_board_mask_t ftk_bishop_attacks(ftk_position_t position, ftk_board_mask_t occupied);
+
+/**
+ * @brief Get squares attacked by a Rook, including the first blocking square of each ray
+ *
+ * @param position Position of the Rook
+ * @param occupied Mask of all occupied squares
+ * @return ftk_board_mask_t
+ */
+ftk_board_mask_t ftk_rook_attacks(ftk_position_t position, ftk_board_mask_t occupied);
+
+/**
+ * @brief Get squares attacked by a Queen, including the first blocking square of each ray
+ *
+ * @param position Position of the Queen
+ * @param occupied Mask of all occupied squares
+ * @return ftk_board_mask_t
+ */
+ftk_board_mask_t ftk_queen_attacks(ftk_position_t position, ftk_board_mask_t occupied);
+
+/**
+ * @brief Get squares attacked by a Knight
+ *
+ * @param position Position of the Knight
+ * @return ftk_board_mask_t
+ */
+ftk_board_mask_t ftk_knight_attacks(ftk_position_t position);
+
+/**
+ * @brief Get squares attacked by a King, castling excluded
+ *
+ * @param position Position of the King
+ * @return ftk_board_mask_t
+ */
+ftk_board_mask_t ftk_king_attacks(ftk_position_t position);
+
+/**
+ * @brief Get squares attacked diagonally by a Pawn
+ *
+ * @param color Color of the Pawn
+ * @param position Position of the Pawn
+ * @return ftk_board_mask_t
+ */
+ftk_board_mask_t ftk_pawn_attacks(ftk_color_e color, ftk_position_t position);
+
+/**
+ * @brief Get squares strictly between two positions sharing a rank, file or diagonal
+ *
+ * @param a
+ * @param b
+ * @return ftk_board_mask_t Empty if positions are not aligned
+ */
+ftk_board_mask_t ftk_between_mask(ftk_position_t a, ftk_position_t b);
+
+/**
+ * @brief Get full rank, file or diagonal passing through two positions, edge to edge
+ *
+ * @param a
+ * @param b
+ * @return ftk_board_mask_t Empty if positions are not aligned
+ */
+ftk_board_mask_t ftk_line_mask(ftk_position_t a, ftk_position_t b);
+
+#endif //_FAREWELL_TO_KING_ATTACK_H_
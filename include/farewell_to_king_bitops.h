@@ -3,7 +3,7 @@
  Farewell To King - Chess Library
  Edward Sandor
  January 2021
- 
+
  Common bit operations
 */
 
@@ -12,31 +12,124 @@
 
 #include "farewell_to_king_types.h"
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 /**
  * @brief Set bit in mask at index
- * 
+ *
  */
 #define FTK_SET_BIT(mask, index)   (mask |= (1ULL<<index))
 /**
  * @brief Clear bit in mask at index
- * 
+ *
  */
 #define FTK_CLEAR_BIT(mask, index) (mask &= ~(1ULL<<index))
 
+/**
+ * @brief Bit operation backend selection.  GCC/Clang builtins or MSVC intrinsics when available, portable C otherwise.
+ *        x86 popcount is dispatched at runtime via CPUID unless the compiler already targets POPCNT (e.g. -mpopcnt,
+ *        -march=native or the FTK_POPCNT build option), in which case the instruction is inlined.
+ *
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define FTK_BITOPS_BUILTIN
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__POPCNT__)
+#define FTK_BITOPS_POPCNT_DISPATCH
+#endif
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define FTK_BITOPS_MSVC
+#if !defined(FTK_POPCNT)
+#define FTK_BITOPS_POPCNT_DISPATCH
+#endif
+#endif
+
+/**
+ * @brief Portable implementations, used when no hardware backend is available
+ *
+ */
+uint_fast8_t ftk_get_num_bits_set_portable(ftk_max_mask_size_t mask);
+uint_fast8_t ftk_get_first_set_bit_idx_portable(ftk_max_mask_size_t mask);
+uint_fast8_t ftk_get_last_set_bit_idx_portable(ftk_max_mask_size_t mask);
+
+#ifdef FTK_BITOPS_POPCNT_DISPATCH
+/**
+ * @brief Popcount implementation selected by CPUID once at library load, called directly so each count is a
+ *        single indirect call
+ *
+ */
+extern uint_fast8_t (*ftk_get_num_bits_set_impl)(ftk_max_mask_size_t mask);
+#endif
+
 /**
  * @brief Get number of bits set in mask
- * 
- * @param mask 
+ *
+ * @param mask
  * @return uint8_t number of bits set in mask
  */
-uint_fast8_t ftk_get_num_bits_set(ftk_max_mask_size_t mask);
+static inline uint_fast8_t ftk_get_num_bits_set(ftk_max_mask_size_t mask)
+{
+#if defined(FTK_BITOPS_POPCNT_DISPATCH)
+  return ftk_get_num_bits_set_impl(mask);
+#elif defined(FTK_BITOPS_BUILTIN)
+  return (uint_fast8_t) __builtin_popcountll(mask);
+#elif defined(FTK_BITOPS_MSVC)
+  return (uint_fast8_t) __popcnt64(mask);
+#else
+  return ftk_get_num_bits_set_portable(mask);
+#endif
+}
 
 /**
- * @brief 
- * 
+ * @brief
+ *
  * @param mask Get first set bit (LSB) index from mask
  * @return uint8_t index of first set bit, 0xFF if empty
  */
-uint_fast8_t ftk_get_first_set_bit_idx(ftk_max_mask_size_t mask);
+static inline uint_fast8_t ftk_get_first_set_bit_idx(ftk_max_mask_size_t mask)
+{
+#if defined(FTK_BITOPS_BUILTIN)
+  return (0 == mask) ? 0xFF : (uint_fast8_t) __builtin_ctzll(mask);
+#elif defined(FTK_BITOPS_MSVC)
+  unsigned long index;
+  return _BitScanForward64(&index, mask) ? (uint_fast8_t) index : 0xFF;
+#else
+  return ftk_get_first_set_bit_idx_portable(mask);
+#endif
+}
+
+/**
+ * @brief
+ *
+ * @param mask Get last set bit (MSB) index from mask
+ * @return uint8_t index of last set bit, 0xFF if empty
+ */
+static inline uint_fast8_t ftk_get_last_set_bit_idx(ftk_max_mask_size_t mask)
+{
+#if defined(FTK_BITOPS_BUILTIN)
+  return (0 == mask) ? 0xFF : (uint_fast8_t) (63 - __builtin_clzll(mask));
+#elif defined(FTK_BITOPS_MSVC)
+  unsigned long index;
+  return _BitScanReverse64(&index, mask) ? (uint_fast8_t) index : 0xFF;
+#else
+  return ftk_get_last_set_bit_idx_portable(mask);
+#endif
+}
+
+/**
+ * @brief Removes first set bit (LSB) from mask, used to iterate set bits
+ *
+ * @param mask Mask to pop bit from, must not be empty
+ * @return uint8_t index of removed bit
+ */
+static inline uint_fast8_t ftk_pop_first_set_bit_idx(ftk_max_mask_size_t *mask)
+{
+  uint_fast8_t index = ftk_get_first_set_bit_idx(*mask);
+
+  *mask &= (*mask - 1);
+
+  return index;
+}
 
 #endif //_FAREWELL_TO_KING_BITOPS_H_
\ No newline at end of file
@@ -25,4 +25,51 @@ void ftk_clear_board(ftk_board_s *board);
  */
 void ftk_set_standard_board(ftk_board_s *board);
 
+/**
+ * @brief Toggles a piece in the color and type masks (add if absent, remove if present)
+ * 
+ * @param board board to update
+ * @param piece piece to toggle, empty squares are ignored
+ * @param position position of the piece
+ */
+static inline void ftk_board_toggle_piece_masks(ftk_board_s *board, ftk_square_s piece, ftk_position_t position)
+{
+  ftk_board_mask_t bit = FTK_POSITION_TO_MASK(position);
+
+  if(FTK_TYPE_EMPTY != piece.type)
+  {
+    if(FTK_COLOR_WHITE == piece.color)
+    {
+      board->white_mask ^= bit;
+    }
+    else
+    {
+      board->black_mask ^= bit;
+    }
+    switch(piece.type)
+    {
+      case FTK_TYPE_PAWN:
+        board->pawn_mask   ^= bit;
+        break;
+      case FTK_TYPE_KNIGHT:
+        board->knight_mask ^= bit;
+        break;
+      case FTK_TYPE_BISHOP:
+        board->bishop_mask ^= bit;
+        break;
+      case FTK_TYPE_ROOK:
+        board->rook_mask   ^= bit;
+        break;
+      case FTK_TYPE_QUEEN:
+        board->queen_mask  ^= bit;
+        break;
+      case FTK_TYPE_KING:
+        board->king_mask   ^= bit;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 #endif //_FAREWELL_TO_KING_BOARD_H_
\ No newline at end of file
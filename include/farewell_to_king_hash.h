@@ -0,0 +1,55 @@
+/*
+ farewell_to_king_hash.h
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains declarations of Zobrist position hashing.
+*/
+
+#ifndef _FAREWELL_TO_KING_HASH_H_
+#define _FAREWELL_TO_KING_HASH_H_
+#include "farewell_to_king_types.h"
+
+/**
+ * @brief Get Zobrist key of a piece on a square
+ *
+ * @param square Piece, empty squares hash to 0
+ * @param position Position of the piece
+ * @return ftk_hash_t
+ */
+ftk_hash_t ftk_hash_piece(ftk_square_s square, ftk_position_t position);
+
+/**
+ * @brief Get Zobrist key of a set of castling rights
+ *
+ * @param castle_rights Castling rights
+ * @return ftk_hash_t
+ */
+ftk_hash_t ftk_hash_castle(ftk_castle_mask_t castle_rights);
+
+/**
+ * @brief Get Zobrist key of an En Passant target, keyed by file
+ *
+ * @param ep En Passant target position, FTK_XX hashes to 0
+ * @return ftk_hash_t
+ */
+ftk_hash_t ftk_hash_ep(ftk_position_t ep);
+
+/**
+ * @brief Get Zobrist key of the side to move
+ *
+ * @param turn Side to move, only Black is keyed
+ * @return ftk_hash_t
+ */
+ftk_hash_t ftk_hash_turn(ftk_color_e turn);
+
+/**
+ * @brief Builds Zobrist hash of a game position from scratch
+ *
+ * @param game Game to hash
+ * @return ftk_hash_t
+ */
+ftk_hash_t ftk_build_hash(const ftk_game_s *game);
+
+#endif //_FAREWELL_TO_KING_HASH_H_
@@ -0,0 +1,32 @@
+/*
+ farewell_to_king_iterator.h
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains declarations of the staged move iterator.
+*/
+
+#ifndef _FAREWELL_TO_KING_ITERATOR_H_
+#define _FAREWELL_TO_KING_ITERATOR_H_
+#include "farewell_to_king_types.h"
+
+/**
+ * @brief Begins iterating legal moves of a game in stages: hash move, winning captures, promotions, quiet moves, losing captures
+ *
+ * @param iterator Iterator to initialize
+ * @param game Game to iterate moves of (Masks not required, each stage is generated from the board)
+ * @param hash_move Move to yield first if legal, FTK_MOVE16_INVALID if none
+ */
+void ftk_move_iterator_init(ftk_move_iterator_s *iterator, const ftk_game_s *game, ftk_move16_t hash_move);
+
+/**
+ * @brief Yields next move, generating the next stage only when the current one is exhausted
+ *
+ * @param iterator Iterator to advance, iterator->stage holds the stage of the yielded move
+ * @param move Output move
+ * @return true if a move was yielded, false once all moves are exhausted
+ */
+bool ftk_move_iterator_next(ftk_move_iterator_s *iterator, ftk_move16_t *move);
+
+#endif //_FAREWELL_TO_KING_ITERATOR_H_
@@ -11,6 +11,32 @@
 #define _FAREWELL_TO_KING_MASK_H_
 #include "farewell_to_king_types.h"
 
+/**
+ * @brief Marks all move and attack masks out of date, call after any change to the position
+ * 
+ * @param masks masks to invalidate
+ */
+static inline void ftk_invalidate_move_masks(ftk_move_masks_s *masks)
+{
+  masks->masks_valid     = false;
+  masks->attacks_valid   = false;
+  masks->move_mask_valid = 0;
+}
+
+/**
+ * @brief Marks stored move masks of a game out of date, nothing is stored with FTK_LEAN_BOARD
+ * 
+ * @param game game to invalidate
+ */
+static inline void ftk_invalidate_game_masks(ftk_game_s *game)
+{
+#ifdef FTK_LEAN_BOARD
+  (void) game;
+#else
+  ftk_invalidate_move_masks(&game->masks);
+#endif
+}
+
 /**
  * @brief Build a board bitmask for all squares of given type
  * 
@@ -53,6 +79,16 @@ void ftk_build_all_masks(ftk_board_s *board);
  */
 ftk_board_mask_t ftk_build_move_mask(const ftk_board_s *board, ftk_position_t position, ftk_position_t *ep);
 
+/**
+ * @brief Adds all Pawn moves of one color to the move masks at once (bitboard shifts instead of per Pawn checks)
+ * 
+ * @param board Board information
+ * @param masks Move masks to add to, Pawn move masks must be cleared before
+ * @param color Pawn color to generate moves for
+ * @param ep En passant square, FTK_XX if none
+ */
+void ftk_build_pawn_move_masks(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_color_e color, ftk_position_t ep);
+
 /**
  * @brief Builds mask describing a path to a specified square 
  * 
@@ -68,21 +104,103 @@ ftk_board_mask_t ftk_build_path_mask(ftk_square_s     square,
                                      ftk_board_mask_t moves);
 
 /**
- * @brief Strips moves from the move mask for any piece whose movement would result in exposed check
+ * @brief Build mask of all squares attacked by pieces of a given color
+ * 
+ * @param board Board information
+ * @param color Attacking color
+ * @param occupied Occupied squares used to block sliding pieces
+ * @return ftk_board_mask_t 
+ */
+ftk_board_mask_t ftk_build_attack_mask(const ftk_board_s *board, ftk_color_e color, ftk_board_mask_t occupied);
+
+/**
+ * @brief Build mask of pieces of either color attacking a position
  * 
- * @param board Board to strip check moves
+ * @param board Board information
+ * @param position Position under attack
+ * @param occupied Occupied squares used to block sliding pieces
+ * @return ftk_board_mask_t 
+ */
+ftk_board_mask_t ftk_build_attackers_mask(const ftk_board_s *board, ftk_position_t position, ftk_board_mask_t occupied);
+
+/**
+ * @brief Build mask of opponent pieces giving check to the King of the current player (Requires only piece masks)
+ * 
+ * @param board Board information
  * @param turn Current turn player color
+ * @return ftk_board_mask_t Empty if not in check or no King
+ */
+ftk_board_mask_t ftk_build_checkers_mask(const ftk_board_s *board, ftk_color_e turn);
+
+/**
+ * @brief Builds white_attacks and black_attacks from piece masks and marks them valid
+ * 
+ * @param board Board to build attack masks for
+ * @param masks Masks to store attack masks in
+ */
+void ftk_build_all_attack_masks(const ftk_board_s *board, ftk_move_masks_s *masks);
+
+/**
+ * @brief Strips moves from the move mask for any piece whose movement would result in exposed check (Requires attack masks)
+ * 
+ * @param board Board information
+ * @param masks Move masks to strip check moves from
+ * @param turn Current turn player color
+ * @param ep En passant square, FTK_XX if none
  * @return ftk_check_e 
  */
-ftk_check_e ftk_strip_check(ftk_board_s *board, ftk_color_e turn);
+ftk_check_e ftk_strip_check(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_color_e turn, ftk_position_t ep);
 
 /**
- * @brief Adds castling to move masks for current player if castling is legal
+ * @brief Adds castling to move masks for current player if castling is legal (Requires attack masks)
  * 
- * @param board Board to add castling to
+ * @param board Board information
+ * @param masks Move masks to add castling to
  * @param turn Current turn player color
+ * @param castle_rights Remaining castling rights
+ */
+void ftk_add_castle(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_color_e turn, ftk_castle_mask_t castle_rights);
+
+/**
+ * @brief Build mask of King castling targets for current player if castling is legal (Requires attack masks)
+ * 
+ * @param board Board information
+ * @param masks Masks holding attack masks
+ * @param turn Current turn player color
+ * @param castle_rights Remaining castling rights
+ * @return ftk_board_mask_t 
+ */
+ftk_board_mask_t ftk_build_castle_mask(const ftk_board_s *board, const ftk_move_masks_s *masks, ftk_color_e turn, ftk_castle_mask_t castle_rights);
+
+/**
+ * @brief Build fully legal move mask for a single square, matching the entry ftk_update_board_masks() would produce
+ *        (King requires attack masks, other pieces only need piece masks)
+ * 
+ * @param board Board information
+ * @param masks Masks holding attack masks
+ * @param turn Current turn player color
+ * @param ep En passant square, FTK_XX if none
+ * @param castle_rights Remaining castling rights
+ * @param position Position to build move mask for
+ * @return ftk_board_mask_t 
+ */
+ftk_board_mask_t ftk_build_legal_move_mask(const ftk_board_s *board, const ftk_move_masks_s *masks, ftk_color_e turn, ftk_position_t ep,
+                                           ftk_castle_mask_t castle_rights, ftk_position_t position);
+
+/**
+ * @brief Build legal moves of a piece of the current player restricted to a set of targets, no move or attack masks required.
+ *        Pieces are only examined for the requested targets, castling is included if its King target is requested
+ * 
+ * @param board Board information
+ * @param turn Current turn player color
+ * @param ep En passant square, FTK_XX if none
+ * @param castle_rights Remaining castling rights
+ * @param position Position of piece, must belong to current player
+ * @param targets Squares of interest
+ * @return ftk_board_mask_t 
  */
-void ftk_add_castle(ftk_board_s *board, ftk_color_e turn);
+ftk_board_mask_t ftk_build_legal_targets(const ftk_board_s *board, ftk_color_e turn, ftk_position_t ep, ftk_castle_mask_t castle_rights,
+                                         ftk_position_t position, ftk_board_mask_t targets);
 
 /**
  * @brief Converts a mask bit to position index (Returns mask MSB if multiple bits are set)
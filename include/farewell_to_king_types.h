@@ -10,6 +10,7 @@
 #ifndef _FAREWELL_TO_KING_TYPES_H_
 #define _FAREWELL_TO_KING_TYPES_H_
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -48,6 +49,12 @@ typedef uint_fast64_t ftk_max_mask_size_t;
  */
 typedef uint_fast64_t ftk_board_mask_t;
 
+/**
+ * @brief Type for representing Zobrist position hashes
+ * 
+ */
+typedef uint64_t ftk_hash_t;
+
 /**
  * @brief Type for representing board positions
  * 
@@ -60,6 +67,18 @@ typedef uint_fast8_t ftk_position_t;
  */
 #define FTK_POSITION_TO_MASK(position) (1ULL << (position))
 
+/**
+ * @brief Masks for board files and ranks
+ * 
+ */
+#define FTK_FILE_A_MASK 0x0101010101010101ULL
+#define FTK_FILE_H_MASK 0x8080808080808080ULL
+#define FTK_RANK_1_MASK 0x00000000000000FFULL
+#define FTK_RANK_3_MASK 0x0000000000FF0000ULL
+#define FTK_RANK_6_MASK 0x0000FF0000000000ULL
+#define FTK_RANK_8_MASK 0xFF00000000000000ULL
+#define FTK_FULL_BOARD_MASK 0xFFFFFFFFFFFFFFFFULL
+
 /**
  * @brief Check state enum
  * 
@@ -127,6 +146,27 @@ typedef enum
  */
 typedef uint8_t ftk_castle_mask_t;
 
+/**
+ * @brief Castling rights of both sides of a color
+ * 
+ */
+#define FTK_CASTLE_COLOR(color)                                                    \
+  ((ftk_castle_mask_t) ((FTK_COLOR_WHITE == (color)) ?                             \
+     (FTK_CASTLE_KING_SIDE_WHITE | FTK_CASTLE_QUEEN_SIDE_WHITE) :                  \
+     (FTK_CASTLE_KING_SIDE_BLACK | FTK_CASTLE_QUEEN_SIDE_BLACK)))
+
+/**
+ * @brief King castling targets of a color, C1 and G1 on its back rank
+ * 
+ */
+#define FTK_CASTLE_TARGETS(color) ((FTK_COLOR_WHITE == (color)) ? 0x0000000000000044ULL : 0x4400000000000000ULL)
+
+/**
+ * @brief Squares castling may require empty or unattacked of a color, C1 through G1 on its back rank
+ * 
+ */
+#define FTK_CASTLE_PATH(color)    ((FTK_COLOR_WHITE == (color)) ? 0x000000000000007CULL : 0x7C00000000000000ULL)
+
 /**
  * @brief Colors enum 
  * 
@@ -167,10 +207,20 @@ typedef enum
 } ftk_moved_status_e;
 
 /**
- * @brief Square state information
+ * @brief Packs structures to their minimum size where supported
+ * 
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define FTK_PACKED __attribute__((packed))
+#else
+#define FTK_PACKED
+#endif
+
+/**
+ * @brief Square state information (one byte where FTK_PACKED is supported)
  * 
  */
-typedef struct {
+typedef struct FTK_PACKED {
   ftk_type_e         type:3;
   ftk_color_e        color:2;
   ftk_moved_status_e moved:2;
@@ -221,22 +271,36 @@ typedef struct {
 typedef uint_fast16_t ftk_move_count_t;
 
 /**
- * @brief Game board structure
+ * @brief Aligns structures to a boundary where supported
  * 
  */
-typedef struct
+#if defined(__GNUC__) || defined(__clang__)
+#define FTK_ALIGNED(n) __attribute__((aligned(n)))
+#elif defined(_MSC_VER)
+#define FTK_ALIGNED(n) __declspec(align(n))
+#else
+#define FTK_ALIGNED(n)
+#endif
+
+/**
+ * @brief Alignment of ftk_board_s, and so of every structure embedding it (ftk_game_s).
+ *        Stack and static objects are aligned by the compiler, heap objects need ftk_alloc_aligned_with() or
+ *        ftk_new_game() as malloc() and the arena only guarantee 16 bytes
+ * 
+ */
+#define FTK_BOARD_ALIGNMENT 64
+
+/**
+ * @brief Game board structure.  Compact position core, two cache lines where FTK_PACKED is supported
+ * 
+ */
+typedef struct FTK_ALIGNED(FTK_BOARD_ALIGNMENT)
 {
-  /* Square contents */
+  /* Square contents, one byte per square */
   ftk_square_s     square[FTK_STD_BOARD_SIZE];
 
-  /* If masks are update to date after move */
-  bool             masks_valid;
-
-  /* Valid moves for a given square */
-  ftk_board_mask_t move_mask[FTK_STD_BOARD_SIZE];
-  
-  /* Various board bitmasks parsed from square array */
-  ftk_board_mask_t board_mask;
+  /* Piece bitboards parsed from square array.  Kept up to date by move functions,
+     ftk_build_all_masks() must be called after modifying squares directly */
   ftk_board_mask_t white_mask;
   ftk_board_mask_t black_mask;
   ftk_board_mask_t pawn_mask;
@@ -245,11 +309,38 @@ typedef struct
   ftk_board_mask_t rook_mask;
   ftk_board_mask_t queen_mask;
   ftk_board_mask_t king_mask;
-
 } ftk_board_s;
 
 /**
- * @brief Game structure
+ * @brief Mask of all occupied squares of a board
+ * 
+ */
+#define FTK_BOARD_OCCUPIED(board) ((board)->white_mask | (board)->black_mask)
+
+/**
+ * @brief Move and attack masks derived from a board, kept apart so the board copies cheaply
+ * 
+ */
+typedef struct
+{
+  /* If masks are update to date after move */
+  bool             masks_valid;
+  /* If attack masks are up to date after move */
+  bool             attacks_valid;
+
+  /* Squares whose move_mask is up to date, all squares if masks_valid.  Cleared with ftk_invalidate_move_masks() */
+  ftk_board_mask_t move_mask_valid;
+
+  /* Squares attacked by each color, valid with masks_valid or attacks_valid */
+  ftk_board_mask_t white_attacks;
+  ftk_board_mask_t black_attacks;
+
+  /* Valid moves for a given square */
+  ftk_board_mask_t move_mask[FTK_STD_BOARD_SIZE];
+} ftk_move_masks_s;
+
+/**
+ * @brief Game structure.  Aligned to FTK_BOARD_ALIGNMENT, allocate on the heap with ftk_new_game()
  * 
  */
 typedef struct 
@@ -260,6 +351,9 @@ typedef struct
   /* Current En Passant target position */
   ftk_position_t   ep;
 
+  /* Remaining castling rights, cleared as Kings and Rooks move or are captured */
+  ftk_castle_mask_t castle_rights;
+
   /* Current turn color */
   ftk_color_e      turn;
 
@@ -267,6 +361,14 @@ typedef struct
   ftk_move_count_t half_move;
   /* Number of full moves in given game */
   ftk_move_count_t full_move;
+
+  /* Zobrist hash of pieces, turn, castling rights and En Passant target, kept up to date by move functions */
+  ftk_hash_t       hash;
+
+#ifndef FTK_LEAN_BOARD
+  /* Move and attack masks of active game board, not needed to copy a position */
+  ftk_move_masks_s masks;
+#endif
 } ftk_game_s;
 
 /**
@@ -287,6 +389,8 @@ typedef struct
 
   /* En Passant target position before this move */
   ftk_position_t   ep;
+  /* Castling rights before this move */
+  ftk_castle_mask_t castle_rights;
   /* Type Pawn is promoted to */
   ftk_type_e       pawn_promotion;
 
@@ -325,9 +429,114 @@ typedef struct
    ((move_a).ep                        == (move_b).ep) &&                        \
    ((move_a).pawn_promotion            == (move_b).pawn_promotion) &&            \
    ((move_a).turn                      == (move_b).turn) &&                      \
+   ((move_a).castle_rights             == (move_b).castle_rights) &&             \
    ((move_a).half_move                 == (move_b).half_move) &&                  \
    ((move_a).full_move                 == (move_b).full_move))
 
+/**
+ * @brief Upper bound of legal moves in any position (218 is the known maximum), sufficient for stack move buffers
+ * 
+ */
+#define FTK_MAX_MOVES 256
+
+/**
+ * @brief Compact move for move lists: source in bits 0-5, target in bits 6-11, promotion type in bits 12-14, capture flag in bit 15
+ * 
+ */
+typedef uint16_t ftk_move16_t;
+
+#define FTK_MOVE16_INVALID ((ftk_move16_t) 0)
+#define FTK_MOVE16_CAPTURE ((ftk_move16_t) 0x8000)
+
+/**
+ * @brief Builds a compact move (Promotion type FTK_TYPE_DONT_CARE if not a promotion)
+ * 
+ */
+#define FTK_MOVE16(source, target, promotion) \
+  ((ftk_move16_t) ((source) | ((target) << 6) | ((promotion) << 12)))
+
+#define FTK_MOVE16_SOURCE(move16)     ((ftk_position_t) ((move16) & 0x3F))
+#define FTK_MOVE16_TARGET(move16)     ((ftk_position_t) (((move16) >> 6) & 0x3F))
+#define FTK_MOVE16_PROMOTION(move16)  ((ftk_type_e) (((move16) >> 12) & 0x7))
+#define FTK_MOVE16_IS_CAPTURE(move16) (0 != ((move16) & FTK_MOVE16_CAPTURE))
+#define FTK_MOVE16_VALID(move16)      (FTK_MOVE16_SOURCE(move16) != FTK_MOVE16_TARGET(move16))
+
+/**
+ * @brief Game state overwritten by a move, kept separately from ftk_move16_t to undo it
+ * 
+ */
+typedef struct
+{
+  /* Moved piece before this move */
+  ftk_square_s     moved;
+  /* Piece captured in this move, or Rook in castle case */
+  ftk_square_s     capture;
+
+  /* En Passant target position before this move */
+  ftk_position_t   ep;
+  /* Turn color before this move */
+  ftk_color_e      turn:2;
+  /* Castling rights before this move */
+  ftk_castle_e     castle_rights:4;
+
+  /* Number of moves before this move */
+  uint16_t         half_move;
+  uint16_t         full_move;
+} ftk_undo_s;
+
+/**
+ * @brief Move generation modes, targets are restricted before legality is tested
+ * 
+ */
+typedef enum
+{
+  /* Captures (en passant included) and all promotions */
+  FTK_GEN_CAPTURES,
+  /* Moves neither capturing nor promoting, castling included */
+  FTK_GEN_QUIETS,
+  /* All legal moves when in check, none otherwise */
+  FTK_GEN_EVASIONS,
+  /* Quiet moves giving direct or discovered check */
+  FTK_GEN_QUIET_CHECKS,
+} ftk_gen_mode_e;
+
+/**
+ * @brief Move iterator stages, in the order moves are yielded
+ * 
+ */
+typedef enum
+{
+  FTK_MOVE_STAGE_HASH,
+  FTK_MOVE_STAGE_GOOD_CAPTURES,
+  FTK_MOVE_STAGE_PROMOTIONS,
+  FTK_MOVE_STAGE_QUIETS,
+  FTK_MOVE_STAGE_BAD_CAPTURES,
+  FTK_MOVE_STAGE_DONE,
+} ftk_move_stage_e;
+
+/**
+ * @brief Staged move iterator, each stage is generated only once reached (stopping after captures skips quiet generation)
+ * 
+ */
+typedef struct
+{
+  /* Game moves are generated for, must not change while iterating */
+  const ftk_game_s *game;
+
+  /* Stage of the last yielded move */
+  ftk_move_stage_e  stage;
+
+  /* Move to yield first, FTK_MOVE16_INVALID if none */
+  ftk_move16_t      hash_move;
+
+  /* Moves of current stage from front, promotions then bad captures saved for their stages at the back */
+  ftk_move16_t      move[FTK_MAX_MOVES];
+  uint_fast16_t     index;
+  uint_fast16_t     count;
+  uint_fast16_t     promotion_count;
+  uint_fast16_t     bad_capture_count;
+} ftk_move_iterator_s;
+
 /**
  * @brief Move list structure
  * 
@@ -341,6 +550,41 @@ typedef struct
 
 } ftk_move_list_s;
 
+/**
+ * @brief Allocation hook, returns NULL on failure
+ * 
+ */
+typedef void * (*ftk_alloc_fn_t)(size_t size, void *context);
+
+/**
+ * @brief Deallocation hook, ptr may be NULL
+ * 
+ */
+typedef void (*ftk_free_fn_t)(void *ptr, void *context);
+
+/**
+ * @brief Allocator every dynamic allocation of the library goes through
+ * 
+ */
+typedef struct
+{
+  ftk_alloc_fn_t  alloc;
+  ftk_free_fn_t   free;
+  /* Passed to hooks unmodified */
+  void           *context;
+} ftk_allocator_s;
+
+/**
+ * @brief Bump allocator over caller provided memory, individual frees are ignored and all memory is released by reset
+ * 
+ */
+typedef struct
+{
+  uint8_t *buffer;
+  size_t   size;
+  size_t   used;
+} ftk_arena_s;
+
 //Square value table
 typedef enum
 {
@@ -15,6 +15,22 @@
 #include "farewell_to_king_types.h"
 #include "farewell_to_king_version.h"
 
+/**
+ * @brief Castling rights cleared by a move from or to each square
+ * 
+ */
+static const ftk_castle_mask_t ftk_castle_rights_clear[FTK_STD_BOARD_SIZE] =
+{
+  [FTK_A1] = FTK_CASTLE_QUEEN_SIDE_WHITE,
+  [FTK_E1] = FTK_CASTLE_KING_SIDE_WHITE | FTK_CASTLE_QUEEN_SIDE_WHITE,
+  [FTK_H1] = FTK_CASTLE_KING_SIDE_WHITE,
+  [FTK_A8] = FTK_CASTLE_QUEEN_SIDE_BLACK,
+  [FTK_E8] = FTK_CASTLE_KING_SIDE_BLACK | FTK_CASTLE_QUEEN_SIDE_BLACK,
+  [FTK_H8] = FTK_CASTLE_KING_SIDE_BLACK,
+};
+
+const ftk_type_e ftk_promotion_types[FTK_NUM_PROMOTIONS] = { FTK_TYPE_QUEEN, FTK_TYPE_KNIGHT, FTK_TYPE_BISHOP, FTK_TYPE_ROOK };
+
 /**
  * @brief Returns name string for Farewell to King Library
  * 
@@ -45,107 +61,328 @@ const char * ftk_get_intro_string()
   return FAREWELL_TO_KING_INTRO;
 }
 
+ftk_game_s * ftk_new_game(const ftk_allocator_s *allocator)
+{
+  return (ftk_game_s *) ftk_alloc_aligned_with(allocator, sizeof(ftk_game_s), FTK_BOARD_ALIGNMENT);
+}
+
+void ftk_delete_game(ftk_game_s *game, const ftk_allocator_s *allocator)
+{
+  ftk_free_aligned_with(allocator, game);
+}
+
 void ftk_begin_standard_game(ftk_game_s *game) 
 {
-  game->board.masks_valid = false;
+  ftk_invalidate_game_masks(game);
 
   ftk_set_standard_board(&game->board);
+  ftk_build_all_masks(&game->board);
 
   game->ep = FTK_XX;
+  game->castle_rights = FTK_CASTLE_ALL;
   game->half_move = 0;
   game->full_move = 1;
 
   game->turn = FTK_COLOR_WHITE;
 
+  game->hash = ftk_build_hash(game);
+
   ftk_update_board_masks(game);
 }
 
+void ftk_copy_game_position(ftk_game_s *dest, const ftk_game_s *src)
+{
+  dest->board         = src->board;
+  dest->ep            = src->ep;
+  dest->turn          = src->turn;
+  dest->castle_rights = src->castle_rights;
+  dest->half_move     = src->half_move;
+  dest->full_move     = src->full_move;
+  dest->hash          = src->hash;
+
+  ftk_invalidate_game_masks(dest);
+}
+
+void ftk_build_move_masks(const ftk_game_s *game, ftk_move_masks_s *masks)
+{
+  ftk_position_t   i;
+  ftk_position_t   ep     = game->ep;
+  ftk_board_mask_t pieces = FTK_BOARD_OCCUPIED(&game->board) & ~game->board.pawn_mask;
+
+  ftk_build_all_attack_masks(&game->board, masks);
+
+  memset(masks->move_mask, 0, sizeof(masks->move_mask));
+  while(pieces)
+  {
+    /* Pawns are generated together below */
+    i = ftk_pop_first_set_bit_idx(&pieces);
+    masks->move_mask[i] = ftk_build_move_mask(&game->board, i, &ep);
+  }
+  ftk_build_pawn_move_masks(&game->board, masks, FTK_COLOR_WHITE, (FTK_COLOR_WHITE == game->turn) ? game->ep : FTK_XX);
+  ftk_build_pawn_move_masks(&game->board, masks, FTK_COLOR_BLACK, (FTK_COLOR_BLACK == game->turn) ? game->ep : FTK_XX);
+
+  ftk_strip_check(&game->board, masks, game->turn, game->ep);
+
+  ftk_add_castle(&game->board, masks, game->turn, game->castle_rights);
+
+  masks->masks_valid     = true;
+  masks->move_mask_valid = FTK_FULL_BOARD_MASK;
+}
+
 void ftk_update_board_masks(ftk_game_s *game) 
 {
-  if(false == game->board.masks_valid)
+#ifdef FTK_LEAN_BOARD
+  /* Nothing stored, masks are built on demand */
+  (void) game;
+#else
+  if(false == game->masks.masks_valid)
+  {
+    ftk_build_move_masks(game, &game->masks);
+  }
+#endif
+}
+
+/**
+ * @brief Get Zobrist key of the turn, castling rights and En Passant target of a game
+ * 
+ */
+static ftk_hash_t ftk_game_state_hash(const ftk_game_s *game)
+{
+  return ftk_hash_turn(game->turn) ^ ftk_hash_castle(game->castle_rights) ^ ftk_hash_ep(game->ep);
+}
+
+/**
+ * @brief Toggles a piece in the board piece masks and game hash
+ * 
+ */
+static void ftk_game_toggle_piece(ftk_game_s *game, ftk_square_s square, ftk_position_t position)
+{
+  ftk_board_toggle_piece_masks(&game->board, square, position);
+  game->hash ^= ftk_hash_piece(square, position);
+}
+
+#ifdef FTK_DEBUG_BUILD
+/**
+ * @brief Verifies incrementally updated hash matches a full rebuild
+ * 
+ * @param game game to verify
+ */
+static void ftk_debug_verify_hash(const ftk_game_s *game)
+{
+  assert(ftk_build_hash(game) == game->hash);
+}
+
+/**
+ * @brief Verifies incrementally updated piece masks match a full rebuild
+ * 
+ * @param board board to verify
+ */
+static void ftk_debug_verify_piece_masks(const ftk_board_s *board)
+{
+  ftk_board_s rebuilt = *board;
+
+  ftk_build_all_masks(&rebuilt);
+
+  assert(rebuilt.white_mask  == board->white_mask);
+  assert(rebuilt.black_mask  == board->black_mask);
+  assert(rebuilt.pawn_mask   == board->pawn_mask);
+  assert(rebuilt.knight_mask == board->knight_mask);
+  assert(rebuilt.bishop_mask == board->bishop_mask);
+  assert(rebuilt.rook_mask   == board->rook_mask);
+  assert(rebuilt.queen_mask  == board->queen_mask);
+  assert(rebuilt.king_mask   == board->king_mask);
+}
+#endif
+
+#if defined(FTK_DEBUG_BUILD) && !defined(FTK_LEAN_BOARD)
+/**
+ * @brief Verifies a lazily built move mask matches a full rebuild
+ * 
+ * @param game game to verify
+ * @param position position of lazily built move mask
+ */
+static void ftk_debug_verify_move_mask(const ftk_game_s *game, ftk_position_t position)
+{
+  ftk_game_s rebuilt = *game;
+
+  ftk_invalidate_move_masks(&rebuilt.masks);
+  ftk_update_board_masks(&rebuilt);
+
+  assert(rebuilt.masks.move_mask[position] == game->masks.move_mask[position]);
+}
+#endif
+
+#ifdef FTK_LEAN_BOARD
+/**
+ * @brief Builds move mask of a single square from piece masks only, matching the entry ftk_build_move_masks() would produce
+ * 
+ */
+static ftk_board_mask_t ftk_build_game_move_mask(const ftk_game_s *game, ftk_position_t position)
+{
+  ftk_position_t ep = FTK_XX;
+
+  if(game->board.square[position].color == game->turn && FTK_TYPE_EMPTY != game->board.square[position].type)
   {
-    ftk_build_all_masks(&game->board);
+    return ftk_build_legal_targets(&game->board, game->turn, game->ep, game->castle_rights, position, FTK_FULL_BOARD_MASK);
+  }
+
+  /* Empty square or opponent piece, basic moves only (opponent may not capture en passant) */
+  return ftk_build_move_mask(&game->board, position, &ep);
+}
+#endif
+
+/**
+ * @brief Gets move mask of a square, stored masks must be up to date for it unless built with FTK_LEAN_BOARD
+ * 
+ */
+static ftk_board_mask_t ftk_game_move_mask(const ftk_game_s *game, ftk_position_t position)
+{
+#ifdef FTK_LEAN_BOARD
+  return ftk_build_game_move_mask(game, position);
+#else
+  assert(game->masks.move_mask_valid & FTK_POSITION_TO_MASK(position));
+  return game->masks.move_mask[position];
+#endif
+}
+
+ftk_board_mask_t ftk_get_move_mask(ftk_game_s *game, ftk_position_t position)
+{
+#ifdef FTK_LEAN_BOARD
+  return ftk_build_game_move_mask(game, position);
+#else
+  ftk_board_mask_t position_mask = FTK_POSITION_TO_MASK(position);
 
-    ftk_position_t i;
-    for(i = 0; i < FTK_STD_BOARD_SIZE; i++)
+  if(0 == (game->masks.move_mask_valid & position_mask))
+  {
+    if(FTK_TYPE_KING == game->board.square[position].type && false == game->masks.attacks_valid)
     {
-      game->board.move_mask[i] = ftk_build_move_mask(&game->board, i, &game->ep);
+      /* King moves and castling depend on opponent attacks, other pieces only need the checkers */
+      ftk_build_all_attack_masks(&game->board, &game->masks);
     }
 
-    ftk_strip_check( &game->board, game->turn);
+    game->masks.move_mask[position] = ftk_build_legal_move_mask(&game->board, &game->masks, game->turn, game->ep, game->castle_rights, position);
+    game->masks.move_mask_valid    |= position_mask;
+
+#ifdef FTK_DEBUG_BUILD
+    ftk_debug_verify_move_mask(game, position);
+#endif
+  }
+
+  return game->masks.move_mask[position];
+#endif
+}
+
+bool ftk_is_legal_move(const ftk_game_s *game, ftk_position_t source, ftk_position_t target, ftk_type_e pawn_promotion)
+{
+  ftk_board_mask_t target_mask;
+  bool             promoting;
+
+  if(source >= FTK_XX || target >= FTK_XX || game->board.square[source].color != game->turn ||
+     FTK_TYPE_EMPTY == game->board.square[source].type)
+  {
+    return false;
+  }
+
+  promoting = (FTK_TYPE_PAWN == game->board.square[source].type) && (0 == target / 8 || 7 == target / 8);
+  if(FTK_TYPE_EMPTY != pawn_promotion && FTK_TYPE_DONT_CARE != pawn_promotion &&
+     (false == promoting || FTK_TYPE_PAWN == pawn_promotion || FTK_TYPE_KING == pawn_promotion))
+  {
+    /* Promotion type given for a move that can not promote, or to a type a Pawn can not become */
+    return false;
+  }
 
-    ftk_add_castle(&game->board, game->turn);
+  target_mask = FTK_POSITION_TO_MASK(target);
 
-    game->board.masks_valid = true;
+#ifndef FTK_LEAN_BOARD
+  if(game->masks.move_mask_valid & FTK_POSITION_TO_MASK(source))
+  {
+    return 0 != (game->masks.move_mask[source] & target_mask);
   }
+#endif
+
+  /* Only the requested target is examined, pseudo-legal misses return before any pin or check test */
+  return 0 != ftk_build_legal_targets(&game->board, game->turn, game->ep, game->castle_rights, source, target_mask);
 }
 
-ftk_move_s ftk_stage_move(const ftk_game_s *game, ftk_position_t target, ftk_position_t source, ftk_type_e pawn_promotion) 
+/**
+ * @brief Stages a move already known to be legal, callers holding the move mask skip rebuilding it
+ * 
+ */
+static ftk_move_s ftk_stage_legal_move(const ftk_game_s *game, ftk_position_t target, ftk_position_t source, ftk_type_e pawn_promotion)
 {
   ftk_move_s move;
-  if((game->board.move_mask[source] & (1ULL << target)) != 0 && game->board.square[source].color == game->turn)
-  {
-    move.source         = source;
-    move.target         = target;
 
-    move.moved          = game->board.square[source];
-    move.capture        = game->board.square[target];
+  move.source         = source;
+  move.target         = target;
 
-    move.ep             = game->ep;
-    move.pawn_promotion = FTK_TYPE_DONT_CARE;
+  move.moved          = game->board.square[source];
+  move.capture        = game->board.square[target];
 
-    move.turn           = game->turn;
-    move.full_move       = game->full_move;
-    move.half_move       = game->half_move;
+  move.ep             = game->ep;
+  move.pawn_promotion = FTK_TYPE_DONT_CARE;
 
-    if(game->board.square[source].type == FTK_TYPE_PAWN)
+  move.turn           = game->turn;
+  move.castle_rights  = game->castle_rights;
+  move.full_move       = game->full_move;
+  move.half_move       = game->half_move;
+
+  if(game->board.square[source].type == FTK_TYPE_PAWN)
+  {
+    if(target == game->ep)
     {
-      if(target == game->ep)
+      if( FTK_COLOR_WHITE == game->turn )
       {
-        if( FTK_COLOR_WHITE == game->turn )
-        {
-          move.capture = game->board.square[game->ep - 8];
-        }
-        else
-        {
-          move.capture = game->board.square[game->ep + 8];
-        }
+        move.capture = game->board.square[game->ep - 8];
       }
-
-      if(0 == target / 8 ||
-         7 == target / 8 )
+      else
       {
-        if(FTK_TYPE_KNIGHT == pawn_promotion ||
-           FTK_TYPE_BISHOP == pawn_promotion ||
-           FTK_TYPE_ROOK   == pawn_promotion ||
-           FTK_TYPE_QUEEN  == pawn_promotion )
-        {
-          move.pawn_promotion = pawn_promotion;
-        }
-        else 
-        {
-          move.pawn_promotion = FTK_TYPE_QUEEN;
-        }
+        move.capture = game->board.square[game->ep + 8];
       }
     }
-    
-    if(game->board.square[source].type == FTK_TYPE_KING)
+
+    if(0 == target / 8 ||
+       7 == target / 8 )
     {
-      if((target - source) == 2){
-        /* Save old Rook */
-        move.capture = game->board.square[source + 3];
+      if(FTK_TYPE_KNIGHT == pawn_promotion ||
+         FTK_TYPE_BISHOP == pawn_promotion ||
+         FTK_TYPE_ROOK   == pawn_promotion ||
+         FTK_TYPE_QUEEN  == pawn_promotion )
+      {
+        move.pawn_promotion = pawn_promotion;
       }
-      if((target - source) == -2){
-        /* Save old Rook */
-        move.capture = game->board.square[source - 4];
+      else 
+      {
+        move.pawn_promotion = FTK_TYPE_QUEEN;
       }
     }
   }
-  else
+  
+  if(game->board.square[source].type == FTK_TYPE_KING)
   {
-    ftk_invalidate_move(&move);
+    if((target - source) == 2){
+      /* Save old Rook */
+      move.capture = game->board.square[source + 3];
+    }
+    if((target - source) == -2){
+      /* Save old Rook */
+      move.capture = game->board.square[source - 4];
+    }
+  }
+
+  return move;
+}
+
+ftk_move_s ftk_stage_move(const ftk_game_s *game, ftk_position_t target, ftk_position_t source, ftk_type_e pawn_promotion) 
+{
+  ftk_move_s move;
+
+  if(game->board.square[source].color == game->turn && (ftk_game_move_mask(game, source) & (1ULL << target)) != 0)
+  {
+    return ftk_stage_legal_move(game, target, source, pawn_promotion);
   }
 
+  ftk_invalidate_move(&move);
+
   return move;
 }
 
@@ -153,7 +390,7 @@ ftk_move_s ftk_move_piece_quick(ftk_game_s *game, ftk_position_t target, ftk_pos
 {
   ftk_move_s move;
 
-  game->board.masks_valid = false;
+  ftk_invalidate_game_masks(game);
 
   if(game->board.square[source].color == game->turn)
   {
@@ -167,9 +404,13 @@ ftk_move_s ftk_move_piece_quick(ftk_game_s *game, ftk_position_t target, ftk_pos
     move.pawn_promotion = FTK_TYPE_DONT_CARE;
 
     move.turn           = game->turn;
+    move.castle_rights  = game->castle_rights;
     move.full_move       = game->full_move;
     move.half_move       = game->half_move;
 
+    /* Remove old turn, castling rights and En Passant keys, new ones are added once the move is made */
+    game->hash ^= ftk_game_state_hash(game);
+
     if(game->turn == FTK_COLOR_BLACK)
     {
       game->full_move++;
@@ -182,6 +423,9 @@ ftk_move_s ftk_move_piece_quick(ftk_game_s *game, ftk_position_t target, ftk_pos
       game->half_move = 0;
     }
 
+    /* Moving from or capturing on a King or Rook home square loses its rights */
+    game->castle_rights &= ~(ftk_castle_rights_clear[source] | ftk_castle_rights_clear[target]);
+
     if(game->board.square[source].type == FTK_TYPE_PAWN)
     {
       if(target == game->ep)
@@ -189,11 +433,13 @@ ftk_move_s ftk_move_piece_quick(ftk_game_s *game, ftk_position_t target, ftk_pos
         if( FTK_COLOR_WHITE == game->turn )
         {
           move.capture = game->board.square[game->ep - 8];
+          ftk_game_toggle_piece(game, move.capture, game->ep - 8);
           FTK_SQUARE_CLEAR(game->board.square[game->ep - 8]);
         }
         else
         {
           move.capture = game->board.square[game->ep + 8];
+          ftk_game_toggle_piece(game, move.capture, game->ep + 8);
           FTK_SQUARE_CLEAR(game->board.square[game->ep + 8]);
         }
       }
@@ -240,6 +486,8 @@ ftk_move_s ftk_move_piece_quick(ftk_game_s *game, ftk_position_t target, ftk_pos
         /* Move Rook */
         game->board.square[target - 1] = game->board.square[source + 3];
         game->board.square[target - 1].moved = FTK_MOVED_HAS_MOVED;
+        ftk_game_toggle_piece(game, move.capture, source + 3);
+        ftk_game_toggle_piece(game, move.capture, target - 1);
         /* Clear old Rook */
         FTK_SQUARE_CLEAR(game->board.square[source + 3]);
       }
@@ -249,15 +497,29 @@ ftk_move_s ftk_move_piece_quick(ftk_game_s *game, ftk_position_t target, ftk_pos
         /* Move Rook */
         game->board.square[target + 1] = game->board.square[source - 4];
         game->board.square[target + 1].moved = FTK_MOVED_HAS_MOVED;
+        ftk_game_toggle_piece(game, move.capture, source - 4);
+        ftk_game_toggle_piece(game, move.capture, target + 1);
         /* Clear old Rook */
         FTK_SQUARE_CLEAR(game->board.square[source - 4]);
       }
     }
 
+    /* Remove captured piece and moved piece (before promotion), add moved piece at target */
+    ftk_game_toggle_piece(game, game->board.square[target], target);
+    ftk_game_toggle_piece(game, move.moved, source);
+    ftk_game_toggle_piece(game, game->board.square[source], target);
+
     game->board.square[target] = game->board.square[source];
     game->board.square[target].moved = FTK_MOVED_HAS_MOVED;
     FTK_SQUARE_CLEAR(game->board.square[source]);
     game->turn = (FTK_COLOR_WHITE == game->turn)? FTK_COLOR_BLACK:FTK_COLOR_WHITE;
+
+    game->hash ^= ftk_game_state_hash(game);
+
+#ifdef FTK_DEBUG_BUILD
+    ftk_debug_verify_piece_masks(&game->board);
+    ftk_debug_verify_hash(game);
+#endif
   }
   else
   {
@@ -314,30 +576,41 @@ ftk_result_e ftk_move_forward(ftk_game_s *game, ftk_move_s *move)
 
 ftk_result_e ftk_move_backward_quick(ftk_game_s *game, ftk_move_s *move) 
 {
-  game->board.masks_valid = false;
+  ftk_invalidate_game_masks(game);
 
   if(move->target == FTK_XX && move->source == FTK_XX)
   {
     return FTK_FAILURE;
   }
 
+  game->hash ^= ftk_game_state_hash(game);
+
+  /* Remove moved piece (after promotion) from target, restore it at source */
+  ftk_game_toggle_piece(game, game->board.square[move->target], move->target);
+  ftk_game_toggle_piece(game, move->moved, move->source);
+
   game->board.square[move->source] = move->moved;
   game->ep                         = move->ep;
   game->turn                       = move->turn;
+  game->castle_rights              = move->castle_rights;
   game->half_move                   = move->half_move;
   game->full_move                   = move->full_move;
 
+  game->hash ^= ftk_game_state_hash(game);
+
   if(move->target == move->ep && FTK_TYPE_PAWN == move->moved.type)
   {
     if(move->turn == FTK_COLOR_WHITE)
     {
       /* Replace captured Pawn */
       game->board.square[move->ep - 8] = move->capture;
+      ftk_game_toggle_piece(game, move->capture, move->ep - 8);
     }
     else
     {
       /* Replace captured Pawn */
       game->board.square[move->ep + 8] = move->capture;
+      ftk_game_toggle_piece(game, move->capture, move->ep + 8);
     }
     /* Clear en pasant square */
     FTK_SQUARE_CLEAR(game->board.square[move->ep]);
@@ -347,25 +620,35 @@ ftk_result_e ftk_move_backward_quick(ftk_game_s *game, ftk_move_s *move)
     /* Reset castle King side */
     /* Clear moved King and Rook */
     FTK_SQUARE_CLEAR(game->board.square[move->target]);
+    ftk_game_toggle_piece(game, game->board.square[move->target - 1], move->target - 1);
     FTK_SQUARE_CLEAR(game->board.square[move->target - 1]);
     /* Replace Rook */
     game->board.square[move->source + 3] = move->capture;
+    ftk_game_toggle_piece(game, move->capture, move->source + 3);
   }    
   else if(move->moved.type == FTK_TYPE_KING && (move->target - move->source) == -2)
   {
     /* Reset castle Queen side */
     /* Clear moved King and Rook */
     FTK_SQUARE_CLEAR(game->board.square[move->target]);
+    ftk_game_toggle_piece(game, game->board.square[move->target + 1], move->target + 1);
     FTK_SQUARE_CLEAR(game->board.square[move->target + 1]);
     /* Replace Rook */
     game->board.square[move->source - 4] = move->capture;
+    ftk_game_toggle_piece(game, move->capture, move->source - 4);
   } 
   else
   {
     /* Restore target square for normal move*/
     game->board.square[move->target] = move->capture;
+    ftk_game_toggle_piece(game, move->capture, move->target);
   }
 
+#ifdef FTK_DEBUG_BUILD
+  ftk_debug_verify_piece_masks(&game->board);
+  ftk_debug_verify_hash(game);
+#endif
+
   return FTK_SUCCESS;
 }
 
@@ -385,45 +668,86 @@ ftk_result_e ftk_move_backward(ftk_game_s *game, ftk_move_s *move)
 
 ftk_check_e ftk_check_for_check(const ftk_game_s *game)
 {
-  ftk_position_t i;
-  ftk_check_e check_status = FTK_CHECK_NO_CHECK;
-  ftk_board_mask_t player_king_mask = game->board.king_mask & ((FTK_COLOR_WHITE == game->turn)?game->board.white_mask:game->board.black_mask);
+  /* Attackers of the King from piece masks only, move and attack masks are not required */
+  return ftk_build_checkers_mask(&game->board, game->turn) ? FTK_CHECK_IN_CHECK : FTK_CHECK_NO_CHECK;
+}
+
+/**
+ * @brief Searches for any legal move without move masks, cheapest candidates first, returning on the first one found
+ * 
+ */
+static bool ftk_find_legal_move(const ftk_game_s *game)
+{
+  const ftk_board_s *board         = &game->board;
+  ftk_board_mask_t   turn_mask     = (FTK_COLOR_WHITE == game->turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t   opponent_mask = (FTK_COLOR_WHITE == game->turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t   king_mask     = board->king_mask & turn_mask;
+  ftk_board_mask_t   pieces        = turn_mask & ~king_mask;
+  ftk_board_mask_t   targets;
+  ftk_position_t     king_position;
+
+  if(king_mask)
+  {
+    /* King steps to unattacked squares, castling is never the only legal move as it requires the step towards the Rook */
+    king_position = ftk_mask_to_position(king_mask);
+    targets       = ftk_king_attacks(king_position) & ~turn_mask;
+    while(targets)
+    {
+      if(0 == (ftk_build_attackers_mask(board, ftk_pop_first_set_bit_idx(&targets), FTK_BOARD_OCCUPIED(board) ^ king_mask) & opponent_mask))
+      {
+        return true;
+      }
+    }
 
-  for(i = 0; i < FTK_STD_BOARD_SIZE; i++)
+    if(ftk_get_num_bits_set(ftk_build_checkers_mask(board, game->turn)) > 1)
+    {
+      /* Double check, only King may move */
+      return false;
+    }
+  }
+
+  /* Remaining pieces, pieces without pseudo-legal moves return before any pin or check test */
+  while(pieces)
   {
-    if(game->board.move_mask[i] & player_king_mask)
+    if(ftk_build_legal_targets(board, game->turn, game->ep, game->castle_rights, ftk_pop_first_set_bit_idx(&pieces), FTK_FULL_BOARD_MASK))
     {
-      check_status = FTK_CHECK_IN_CHECK;
-      break;
+      return true;
     }
   }
 
-  return check_status;
+  return false;
 }
 
 bool ftk_check_legal_moves(const ftk_game_s *game)
 {
+#ifndef FTK_LEAN_BOARD
   bool ret_val = false;
   ftk_position_t i;
+  ftk_board_mask_t pieces = (FTK_COLOR_WHITE == game->turn) ? game->board.white_mask : game->board.black_mask;
 
-  for(i = 0; i < FTK_STD_BOARD_SIZE; i++)
+  if(game->masks.masks_valid)
   {
-    if(game->board.square[i].color == game->turn && game->board.move_mask[i])
+    while(pieces)
     {
-      ret_val = true;
-      break;
+      i = ftk_pop_first_set_bit_idx(&pieces);
+      if(game->masks.move_mask[i])
+      {
+        ret_val = true;
+        break;
+      }
     }
+
+    return ret_val;
   }
+#endif
 
-  return ret_val;
+  return ftk_find_legal_move(game);
 }
 
 ftk_game_end_e ftk_check_for_game_end(const ftk_game_s *game)
 {
   ftk_game_end_e game_end = FTK_END_NOT_OVER;
 
-  assert(game->board.masks_valid);
-
   if( false == ftk_check_legal_moves(game) )
   {
     game_end = (FTK_CHECK_IN_CHECK == ftk_check_for_check(game))?FTK_END_CHECKMATE:FTK_END_DRAW_STALEMATE;
@@ -435,67 +759,363 @@ ftk_game_end_e ftk_check_for_game_end(const ftk_game_s *game)
   return game_end;
 }
 
+size_t ftk_generate_moves(const ftk_game_s *game, ftk_move_s *buffer, size_t capacity)
+{
+  ftk_position_t   i, target;
+  ftk_board_mask_t targets;
+  ftk_board_mask_t pieces = (FTK_COLOR_WHITE == game->turn) ? game->board.white_mask : game->board.black_mask;
+  size_t           count  = 0;
+  size_t           p;
+
+  while(pieces)
+  {
+    i       = ftk_pop_first_set_bit_idx(&pieces);
+    targets = ftk_game_move_mask(game, i);
+
+    if(FTK_TYPE_PAWN == game->board.square[i].type && (targets & (FTK_RANK_1_MASK | FTK_RANK_8_MASK)))
+    {
+      /* Pawn reaching last rank, one move per promotion type */
+      while(targets)
+      {
+        target = ftk_pop_first_set_bit_idx(&targets);
+        for(p = 0; p < FTK_NUM_PROMOTIONS; p++)
+        {
+          if(count < capacity)
+          {
+            buffer[count] = ftk_stage_legal_move(game, target, i, ftk_promotion_types[p]);
+          }
+          count++;
+        }
+      }
+    }
+    else if(count + ftk_get_num_bits_set(targets) <= capacity)
+    {
+      while(targets)
+      {
+        target = ftk_pop_first_set_bit_idx(&targets);
+        buffer[count++] = ftk_stage_legal_move(game, target, i, FTK_TYPE_DONT_CARE);
+      }
+    }
+    else
+    {
+      /* Buffer full, count remaining moves only */
+      while(targets && count < capacity)
+      {
+        target = ftk_pop_first_set_bit_idx(&targets);
+        buffer[count++] = ftk_stage_legal_move(game, target, i, FTK_TYPE_DONT_CARE);
+      }
+      count += ftk_get_num_bits_set(targets);
+    }
+  }
+
+  return count;
+}
+
 /**
- * @brief Get list of legal moves for given game
+ * @brief Build squares from which each piece type of the current player would check the opponent King, Kings never give direct check
  * 
- * @param game game to generate list for
- * @param move_list list of legal moves (memory allocated accordingly)
  */
-void ftk_get_move_list(const ftk_game_s *game, ftk_move_list_s * move_list)
+static void ftk_build_check_squares(const ftk_board_s *board, ftk_color_e turn, ftk_board_mask_t check_squares[FTK_TYPE_DONT_CARE])
 {
-  int i; 
-  ftk_position_t target;
-  ftk_board_mask_t move_mask_temp;
-  ftk_move_count_t move_index = 0;
-  ftk_move_count_t base_move_count = 0;
+  ftk_board_mask_t opponent_king = board->king_mask & ((FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask);
+  ftk_position_t   king_position;
 
-  assert(game->board.masks_valid);
+  memset(check_squares, 0, FTK_TYPE_DONT_CARE * sizeof(ftk_board_mask_t));
 
-  memset(move_list, 0, sizeof(ftk_move_list_s));
+  if(opponent_king)
+  {
+    king_position = ftk_mask_to_position(opponent_king);
+
+    check_squares[FTK_TYPE_PAWN]   = ftk_pawn_attacks((FTK_COLOR_WHITE == turn) ? FTK_COLOR_BLACK : FTK_COLOR_WHITE, king_position);
+    check_squares[FTK_TYPE_KNIGHT] = ftk_knight_attacks(king_position);
+    check_squares[FTK_TYPE_BISHOP] = ftk_bishop_attacks(king_position, FTK_BOARD_OCCUPIED(board));
+    check_squares[FTK_TYPE_ROOK]   = ftk_rook_attacks(king_position, FTK_BOARD_OCCUPIED(board));
+    check_squares[FTK_TYPE_QUEEN]  = check_squares[FTK_TYPE_BISHOP] | check_squares[FTK_TYPE_ROOK];
+  }
+}
+
+/**
+ * @brief Build pieces of the current player that uncover check on the opponent King when moving off their line
+ * 
+ */
+static ftk_board_mask_t ftk_build_discoverers_mask(const ftk_board_s *board, ftk_color_e turn)
+{
+  ftk_board_mask_t turn_mask     = (FTK_COLOR_WHITE == turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t opponent_king = board->king_mask & ((FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask);
+  ftk_board_mask_t discoverers   = 0;
+  ftk_board_mask_t snipers, blockers;
+  ftk_position_t   king_position;
 
-  for(i = 0; i < FTK_STD_BOARD_SIZE; i++)
+  if(opponent_king)
   {
-    if(game->board.square[i].color == game->turn)
+    king_position = ftk_mask_to_position(opponent_king);
+    snipers = ((ftk_rook_attacks(king_position, 0)   & (board->rook_mask   | board->queen_mask)) |
+               (ftk_bishop_attacks(king_position, 0) & (board->bishop_mask | board->queen_mask))) & turn_mask;
+    while(snipers)
     {
-      base_move_count += ftk_get_num_bits_set(game->board.move_mask[i]);
+      blockers = ftk_between_mask(king_position, ftk_pop_first_set_bit_idx(&snipers)) & FTK_BOARD_OCCUPIED(board);
+      if((blockers & turn_mask) && 1 == ftk_get_num_bits_set(blockers))
+      {
+        discoverers |= blockers;
+      }
     }
   }
 
-  move_list->move = (ftk_move_s*) malloc(base_move_count * sizeof(ftk_move_s));
-  move_list->count = base_move_count;
-  assert(move_list->move);
+  return discoverers;
+}
+
+/**
+ * @brief Build King castling targets that give check with the castled Rook
+ * 
+ */
+static ftk_board_mask_t ftk_build_castle_check_targets(const ftk_board_s *board, ftk_color_e turn, ftk_position_t king_position)
+{
+  ftk_board_mask_t opponent_king = board->king_mask & ((FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask);
+  ftk_position_t   back_rank     = (FTK_COLOR_WHITE == turn) ? FTK_A1 : FTK_A8;
+  ftk_board_mask_t targets       = 0;
+  ftk_board_mask_t occupied;
 
-  for(i = 0; i < FTK_STD_BOARD_SIZE; i++)
+  if(FTK_E1 + back_rank == king_position)
   {
-    if(game->board.square[i].color == game->turn)
+    /* King side, King E to G and Rook H to F */
+    occupied = FTK_BOARD_OCCUPIED(board) ^ FTK_POSITION_TO_MASK(FTK_E1 + back_rank) ^ FTK_POSITION_TO_MASK(FTK_G1 + back_rank) ^
+                                   FTK_POSITION_TO_MASK(FTK_H1 + back_rank) ^ FTK_POSITION_TO_MASK(FTK_F1 + back_rank);
+    if(ftk_rook_attacks(FTK_F1 + back_rank, occupied) & opponent_king)
     {
-      move_mask_temp = game->board.move_mask[i];
+      targets |= FTK_POSITION_TO_MASK(FTK_G1 + back_rank);
+    }
 
-      while(move_mask_temp != 0)
-      {
-        target = ftk_get_first_set_bit_idx(move_mask_temp);
-        FTK_CLEAR_BIT(move_mask_temp, target);
+    /* Queen side, King E to C and Rook A to D */
+    occupied = FTK_BOARD_OCCUPIED(board) ^ FTK_POSITION_TO_MASK(FTK_E1 + back_rank) ^ FTK_POSITION_TO_MASK(FTK_C1 + back_rank) ^
+                                   FTK_POSITION_TO_MASK(FTK_A1 + back_rank) ^ FTK_POSITION_TO_MASK(FTK_D1 + back_rank);
+    if(ftk_rook_attacks(FTK_D1 + back_rank, occupied) & opponent_king)
+    {
+      targets |= FTK_POSITION_TO_MASK(FTK_C1 + back_rank);
+    }
+  }
 
-        assert(move_index < base_move_count);
+  return targets;
+}
 
-        move_list->move[move_index] = ftk_stage_move(game, target, i, FTK_TYPE_DONT_CARE);
+/**
+ * @brief Adds compact moves of a piece to each target, one move per promotion type for Pawns reaching the last rank
+ * 
+ * @return size_t updated count, moves beyond capacity are counted but not written
+ */
+static size_t ftk_add_move16_targets(const ftk_game_s *game, ftk_position_t source, ftk_board_mask_t targets,
+                                     ftk_move16_t *buffer, size_t capacity, size_t count)
+{
+  const ftk_board_s *board         = &game->board;
+  bool               pawn          = (FTK_TYPE_PAWN == board->square[source].type);
+  ftk_board_mask_t   opponent_mask = (FTK_COLOR_WHITE == game->turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t   capture_mask  = opponent_mask | ((pawn && game->ep < FTK_XX) ? FTK_POSITION_TO_MASK(game->ep) : 0);
+  ftk_position_t     target;
+  ftk_move16_t       capture;
+  size_t             p;
+
+  while(targets)
+  {
+    target  = ftk_pop_first_set_bit_idx(&targets);
+    capture = (capture_mask & FTK_POSITION_TO_MASK(target)) ? FTK_MOVE16_CAPTURE : 0;
 
-        if(FTK_TYPE_QUEEN == move_list->move[move_index].pawn_promotion)
+    if(pawn && (FTK_POSITION_TO_MASK(target) & (FTK_RANK_1_MASK | FTK_RANK_8_MASK)))
+    {
+      for(p = 0; p < FTK_NUM_PROMOTIONS; p++)
+      {
+        if(count < capacity)
         {
-          /* Pawn was promoted, include alternate promotions */
-          move_list->move = (ftk_move_s*) realloc(move_list->move, (move_list->count+3) * sizeof(ftk_move_s));
-          assert(move_list->move);
-          move_list->move[move_list->count++] = ftk_stage_move(game, target, i, FTK_TYPE_KNIGHT);
-          move_list->move[move_list->count++] = ftk_stage_move(game, target, i, FTK_TYPE_BISHOP);
-          move_list->move[move_list->count++] = ftk_stage_move(game, target, i, FTK_TYPE_ROOK);
+          buffer[count] = FTK_MOVE16(source, target, ftk_promotion_types[p]) | capture;
         }
-        
-        move_index++;
+        count++;
       }
     }
+    else
+    {
+      if(count < capacity)
+      {
+        buffer[count] = FTK_MOVE16(source, target, FTK_TYPE_DONT_CARE) | capture;
+      }
+      count++;
+    }
+  }
+
+  return count;
+}
+
+size_t ftk_generate_moves_by_mode(const ftk_game_s *game, ftk_gen_mode_e mode, ftk_move16_t *buffer, size_t capacity)
+{
+  const ftk_board_s *board         = &game->board;
+  ftk_board_mask_t   turn_mask     = (FTK_COLOR_WHITE == game->turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t   opponent_mask = (FTK_COLOR_WHITE == game->turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t   empty         = ~FTK_BOARD_OCCUPIED(board);
+  ftk_board_mask_t   last_ranks    = FTK_RANK_1_MASK | FTK_RANK_8_MASK;
+  ftk_board_mask_t   ep_mask       = (game->ep < FTK_XX) ? FTK_POSITION_TO_MASK(game->ep) : 0;
+  ftk_board_mask_t   pieces        = turn_mask;
+  ftk_board_mask_t   check_squares[FTK_TYPE_DONT_CARE];
+  ftk_board_mask_t   discoverers   = 0;
+  ftk_board_mask_t   checkers;
+  ftk_board_mask_t   targets;
+  ftk_position_t     opponent_king = ftk_mask_to_position(board->king_mask & opponent_mask);
+  ftk_position_t     i;
+  ftk_type_e         type;
+  size_t             count = 0;
+
+  if(FTK_GEN_EVASIONS == mode)
+  {
+    checkers = ftk_build_checkers_mask(board, game->turn);
+    if(0 == checkers)
+    {
+      return 0;
+    }
+    if(ftk_get_num_bits_set(checkers) > 1)
+    {
+      /* Double check, only King may move */
+      pieces = board->king_mask & turn_mask;
+    }
+  }
+  else if(FTK_GEN_QUIET_CHECKS == mode)
+  {
+    ftk_build_check_squares(board, game->turn, check_squares);
+    discoverers = ftk_build_discoverers_mask(board, game->turn);
+  }
+
+  while(pieces)
+  {
+    i    = ftk_pop_first_set_bit_idx(&pieces);
+    type = board->square[i].type;
+
+    /* Restrict targets to the mode before any legality testing */
+    switch(mode)
+    {
+      case FTK_GEN_CAPTURES:
+        targets = opponent_mask | ((FTK_TYPE_PAWN == type) ? (ep_mask | (empty & last_ranks)) : 0);
+        break;
+      case FTK_GEN_QUIETS:
+        targets = empty & ~((FTK_TYPE_PAWN == type) ? (ep_mask | last_ranks) : 0);
+        break;
+      case FTK_GEN_QUIET_CHECKS:
+        targets = check_squares[type];
+        if(discoverers & FTK_POSITION_TO_MASK(i))
+        {
+          targets |= ~ftk_line_mask(opponent_king, i);
+        }
+        if(FTK_TYPE_KING == type)
+        {
+          targets |= ftk_build_castle_check_targets(board, game->turn, i);
+        }
+        targets &= empty & ~((FTK_TYPE_PAWN == type) ? (ep_mask | last_ranks) : 0);
+        break;
+      default:
+        targets = FTK_FULL_BOARD_MASK;
+        break;
+    }
+
+    if(0 == targets)
+    {
+      continue;
+    }
+    targets = ftk_build_legal_targets(board, game->turn, game->ep, game->castle_rights, i, targets);
+
+    count = ftk_add_move16_targets(game, i, targets, buffer, capacity, count);
+  }
+
+  return count;
+}
+
+size_t ftk_generate_pseudo_legal_moves(const ftk_game_s *game, ftk_move16_t *buffer, size_t capacity)
+{
+  const ftk_board_s *board  = &game->board;
+  ftk_board_mask_t   pieces = (FTK_COLOR_WHITE == game->turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t   castle_targets = FTK_CASTLE_TARGETS(game->turn);
+  ftk_position_t     ep     = game->ep;
+  ftk_position_t     i;
+  ftk_board_mask_t   targets;
+  size_t             count = 0;
+
+  while(pieces)
+  {
+    i       = ftk_pop_first_set_bit_idx(&pieces);
+    targets = ftk_build_move_mask(board, i, &ep);
+
+    if(FTK_TYPE_KING == board->square[i].type && (game->castle_rights & FTK_CASTLE_COLOR(game->turn)))
+    {
+      /* Castling legality depends on the King's whole path, generated fully legal */
+      targets |= ftk_build_legal_targets(board, game->turn, game->ep, game->castle_rights, i, castle_targets);
+    }
+
+    count = ftk_add_move16_targets(game, i, targets, buffer, capacity, count);
+  }
+
+  return count;
+}
+
+bool ftk_move_is_legal_after_pseudo(const ftk_game_s *game, ftk_move16_t move16)
+{
+  const ftk_board_s *board         = &game->board;
+  ftk_position_t     source        = FTK_MOVE16_SOURCE(move16);
+  ftk_position_t     target        = FTK_MOVE16_TARGET(move16);
+  ftk_board_mask_t   turn_mask     = (FTK_COLOR_WHITE == game->turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t   opponent_mask = (FTK_COLOR_WHITE == game->turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t   king_mask     = board->king_mask & turn_mask;
+  ftk_board_mask_t   captured      = FTK_POSITION_TO_MASK(target);
+  ftk_board_mask_t   occupied      = (FTK_BOARD_OCCUPIED(board) ^ FTK_POSITION_TO_MASK(source)) | FTK_POSITION_TO_MASK(target);
+  ftk_position_t     king_position;
+
+  if(0 == king_mask)
+  {
+    return true;
+  }
+
+  if(king_mask & FTK_POSITION_TO_MASK(source))
+  {
+    if(2 == target - source || -2 == target - source)
+    {
+      /* Castling is only generated when legal */
+      return true;
+    }
+    king_position = target;
+  }
+  else
+  {
+    king_position = ftk_mask_to_position(king_mask);
+
+    if(FTK_TYPE_PAWN == board->square[source].type && target == game->ep)
+    {
+      /* En passant removes the Pawn behind the target */
+      captured  = FTK_POSITION_TO_MASK((FTK_COLOR_WHITE == game->turn) ? target - 8 : target + 8);
+      occupied ^= captured;
+    }
   }
 
-  assert(move_index == base_move_count);
+  /* A captured piece no longer attacks */
+  return 0 == (ftk_build_attackers_mask(board, king_position, occupied) & opponent_mask & ~captured);
+}
+
+/**
+ * @brief Get list of legal moves for given game
+ * 
+ * @param game game to generate list for
+ * @param move_list list of legal moves (memory allocated accordingly)
+ */
+void ftk_get_move_list(const ftk_game_s *game, ftk_move_list_s * move_list)
+{
+  ftk_get_move_list_with(game, move_list, NULL);
+}
+
+void ftk_get_move_list_with(const ftk_game_s *game, ftk_move_list_s * move_list, const ftk_allocator_s *allocator)
+{
+  ftk_move_s moves[FTK_MAX_MOVES];
+  size_t     count = ftk_generate_moves(game, moves, FTK_MAX_MOVES);
+
+  memset(move_list, 0, sizeof(ftk_move_list_s));
+
+  /* Generated once into the stack, without stored masks a counting pass would build every mask twice */
+  move_list->move = (ftk_move_s*) ftk_alloc_with(allocator, count * sizeof(ftk_move_s));
+  if(move_list->move)
+  {
+    memcpy(move_list->move, moves, count * sizeof(ftk_move_s));
+    move_list->count = (ftk_move_count_t) count;
+  }
 }
 
 /**
@@ -505,7 +1125,12 @@ void ftk_get_move_list(const ftk_game_s *game, ftk_move_list_s * move_list)
  */
 void ftk_delete_move_list(ftk_move_list_s * move_list)
 {
-  free(move_list->move);
+  ftk_delete_move_list_with(move_list, NULL);
+}
+
+void ftk_delete_move_list_with(ftk_move_list_s * move_list, const ftk_allocator_s *allocator)
+{
+  ftk_free_with(allocator, move_list->move);
 }
 
 /**
@@ -522,8 +1147,110 @@ void ftk_invalidate_move(ftk_move_s *move)
   FTK_SQUARE_CLEAR(move->capture);
 
   move->ep       = FTK_XX;
+  move->castle_rights = FTK_CASTLE_NONE;
 
   move->turn     = 0;
   move->full_move = 0;
   move->half_move = 0;
-}
\ No newline at end of file
+}
+
+ftk_move16_t ftk_move_to_move16(const ftk_move_s *move)
+{
+  ftk_move16_t move16 = FTK_MOVE16_INVALID;
+  bool         castle = (FTK_TYPE_KING == move->moved.type) && (2 == abs((int) move->target - (int) move->source));
+
+  if(FTK_MOVE_VALID(*move))
+  {
+    move16 = FTK_MOVE16(move->source, move->target, move->pawn_promotion);
+
+    if(FTK_TYPE_EMPTY != move->capture.type && false == castle)
+    {
+      move16 |= FTK_MOVE16_CAPTURE;
+    }
+  }
+
+  return move16;
+}
+
+void ftk_move_to_undo(const ftk_move_s *move, ftk_undo_s *undo)
+{
+  undo->moved         = move->moved;
+  undo->capture       = move->capture;
+  undo->ep            = move->ep;
+  undo->turn          = move->turn;
+  undo->castle_rights = (ftk_castle_e) move->castle_rights;
+  undo->half_move     = (uint16_t) move->half_move;
+  undo->full_move     = (uint16_t) move->full_move;
+}
+
+ftk_move_s ftk_move16_to_move(ftk_move16_t move16, const ftk_undo_s *undo)
+{
+  ftk_move_s move;
+
+  if(FTK_MOVE16_VALID(move16))
+  {
+    move.source         = FTK_MOVE16_SOURCE(move16);
+    move.target         = FTK_MOVE16_TARGET(move16);
+    move.pawn_promotion = FTK_MOVE16_PROMOTION(move16);
+
+    move.moved          = undo->moved;
+    move.capture        = undo->capture;
+    move.ep             = undo->ep;
+    move.turn           = undo->turn;
+    move.castle_rights  = undo->castle_rights;
+    move.half_move      = undo->half_move;
+    move.full_move      = undo->full_move;
+  }
+  else
+  {
+    ftk_invalidate_move(&move);
+  }
+
+  return move;
+}
+
+ftk_result_e ftk_move16_forward_quick(ftk_game_s *game, ftk_move16_t move16, ftk_undo_s *undo)
+{
+  ftk_move_s move;
+
+  if(false == FTK_MOVE16_VALID(move16))
+  {
+    return FTK_FAILURE;
+  }
+
+  move = ftk_move_piece_quick(game, FTK_MOVE16_TARGET(move16), FTK_MOVE16_SOURCE(move16), FTK_MOVE16_PROMOTION(move16));
+
+  if(false == FTK_MOVE_VALID(move))
+  {
+    return FTK_FAILURE;
+  }
+
+  ftk_move_to_undo(&move, undo);
+
+  return FTK_SUCCESS;
+}
+
+ftk_result_e ftk_move16_backward_quick(ftk_game_s *game, ftk_move16_t move16, const ftk_undo_s *undo)
+{
+  ftk_move_s move = ftk_move16_to_move(move16, undo);
+
+  return ftk_move_backward_quick(game, &move);
+}
+
+ftk_result_e ftk_position_make_copy(const ftk_game_s *parent, ftk_move16_t move16, ftk_game_s *child)
+{
+  ftk_move_s move;
+
+  assert(parent != child);
+
+  ftk_copy_game_position(child, parent);
+
+  if(false == FTK_MOVE16_VALID(move16))
+  {
+    return FTK_FAILURE;
+  }
+
+  move = ftk_move_piece_quick(child, FTK_MOVE16_TARGET(move16), FTK_MOVE16_SOURCE(move16), FTK_MOVE16_PROMOTION(move16));
+
+  return FTK_MOVE_VALID(move) ? FTK_SUCCESS : FTK_FAILURE;
+}
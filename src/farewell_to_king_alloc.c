@@ -0,0 +1,147 @@
+/*
+ farewell_to_king_alloc.c
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains implementation of the allocator hooks and bundled bump arena.
+*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "farewell_to_king_alloc.h"
+
+static void * ftk_default_alloc(size_t size, void *context)
+{
+  (void) context;
+  return malloc(size);
+}
+
+static void ftk_default_free(void *ptr, void *context)
+{
+  (void) context;
+  free(ptr);
+}
+
+/**
+ * @brief Current allocator
+ * 
+ */
+static ftk_allocator_s ftk_allocator = { ftk_default_alloc, ftk_default_free, NULL };
+
+void ftk_set_allocator(const ftk_allocator_s *allocator)
+{
+  if(allocator)
+  {
+    ftk_allocator = *allocator;
+  }
+  else
+  {
+    ftk_allocator.alloc   = ftk_default_alloc;
+    ftk_allocator.free    = ftk_default_free;
+    ftk_allocator.context = NULL;
+  }
+}
+
+void * ftk_alloc(size_t size)
+{
+  return ftk_alloc_with(NULL, size);
+}
+
+void ftk_free(void *ptr)
+{
+  ftk_free_with(NULL, ptr);
+}
+
+void * ftk_alloc_with(const ftk_allocator_s *allocator, size_t size)
+{
+  if(NULL == allocator)
+  {
+    allocator = &ftk_allocator;
+  }
+
+  return allocator->alloc(size, allocator->context);
+}
+
+void ftk_free_with(const ftk_allocator_s *allocator, void *ptr)
+{
+  if(NULL == allocator)
+  {
+    allocator = &ftk_allocator;
+  }
+
+  allocator->free(ptr, allocator->context);
+}
+
+void * ftk_alloc_aligned_with(const ftk_allocator_s *allocator, size_t size, size_t alignment)
+{
+  uint8_t   *raw;
+  uintptr_t  address;
+
+  assert(alignment >= sizeof(void *) && 0 == (alignment & (alignment - 1)));
+
+  /* Room to align and to keep the unaligned pointer just before the returned block */
+  raw = (uint8_t *) ftk_alloc_with(allocator, size + alignment - 1 + sizeof(void *));
+  if(NULL == raw)
+  {
+    return NULL;
+  }
+
+  address = ((uintptr_t) (raw + sizeof(void *)) + (alignment - 1)) & ~(uintptr_t) (alignment - 1);
+  ((void **) address)[-1] = raw;
+
+  return (void *) address;
+}
+
+void ftk_free_aligned_with(const ftk_allocator_s *allocator, void *ptr)
+{
+  if(ptr)
+  {
+    ftk_free_with(allocator, ((void **) ptr)[-1]);
+  }
+}
+
+static void * ftk_arena_alloc(size_t size, void *context)
+{
+  ftk_arena_s *arena   = (ftk_arena_s *) context;
+  uintptr_t    address = (uintptr_t) &arena->buffer[arena->used];
+  /* Align the address, the caller's buffer may itself be unaligned */
+  size_t       start   = arena->used + (size_t) ((FTK_ARENA_ALIGNMENT - (address % FTK_ARENA_ALIGNMENT)) % FTK_ARENA_ALIGNMENT);
+
+  if(start > arena->size || size > arena->size - start)
+  {
+    return NULL;
+  }
+
+  arena->used = start + size;
+
+  return &arena->buffer[start];
+}
+
+static void ftk_arena_free(void *ptr, void *context)
+{
+  /* Released by ftk_arena_reset() */
+  (void) ptr;
+  (void) context;
+}
+
+void ftk_arena_init(ftk_arena_s *arena, void *buffer, size_t size)
+{
+  arena->buffer = (uint8_t *) buffer;
+  arena->size   = size;
+  arena->used   = 0;
+}
+
+void ftk_arena_reset(ftk_arena_s *arena)
+{
+  arena->used = 0;
+}
+
+void ftk_arena_allocator(ftk_arena_s *arena, ftk_allocator_s *allocator)
+{
+  allocator->alloc   = ftk_arena_alloc;
+  allocator->free    = ftk_arena_free;
+  allocator->context = arena;
+}
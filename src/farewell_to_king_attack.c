@@ -0,0 +1,57 @@
+/*
+ farewell_to_king_attack.c
+ FarewellToKing - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains implementation of precomputed attack table lookups.  Tables are generated at build time
+ by tools/farewell_to_king_table_gen.c so no runtime initialization is required.
+*/
+
+#include "farewell_to_king_attack.h"
+#include "farewell_to_king_tables.h"
+#include "farewell_to_king_types.h"
+
+ftk_board_mask_t ftk_bishop_attacks(ftk_position_t position, ftk_board_mask_t occupied)
+{
+  const ftk_magic_s *magic = &ftk_bishop_magic[position];
+
+  return ftk_bishop_attack_table[magic->offset + ((((occupied & magic->mask) * magic->magic) & 0xFFFFFFFFFFFFFFFFULL) >> magic->shift)];
+}
+
+ftk_board_mask_t ftk_rook_attacks(ftk_position_t position, ftk_board_mask_t occupied)
+{
+  const ftk_magic_s *magic = &ftk_rook_magic[position];
+
+  return ftk_rook_attack_table[magic->offset + ((((occupied & magic->mask) * magic->magic) & 0xFFFFFFFFFFFFFFFFULL) >> magic->shift)];
+}
+
+ftk_board_mask_t ftk_queen_attacks(ftk_position_t position, ftk_board_mask_t occupied)
+{
+  return ftk_bishop_attacks(position, occupied) | ftk_rook_attacks(position, occupied);
+}
+
+ftk_board_mask_t ftk_knight_attacks(ftk_position_t position)
+{
+  return ftk_knight_attack_table[position];
+}
+
+ftk_board_mask_t ftk_king_attacks(ftk_position_t position)
+{
+  return ftk_king_attack_table[position];
+}
+
+ftk_board_mask_t ftk_pawn_attacks(ftk_color_e color, ftk_position_t position)
+{
+  return ftk_pawn_attack_table[(FTK_COLOR_WHITE == color) ? 0 : 1][position];
+}
+
+ftk_board_mask_t ftk_between_mask(ftk_position_t a, ftk_position_t b)
+{
+  return ftk_between_table[a][b];
+}
+
+ftk_board_mask_t ftk_line_mask(ftk_position_t a, ftk_position_t b)
+{
+  return ftk_line_table[a][b];
+}
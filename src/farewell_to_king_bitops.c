@@ -3,56 +3,127 @@
  FarewellToKing - Chess Library
  Edward Sandor
  January 2021
- 
+
  Common bit operations
 */
 
 #include "farewell_to_king_bitops.h"
 
 /**
- * @brief Return number of bits set in mask
- * 
- * @param mask 
+ * @brief Return number of bits set in mask (SWAR)
+ *
+ * @param mask
  */
-uint_fast8_t ftk_get_num_bits_set(ftk_max_mask_size_t mask)
+uint_fast8_t ftk_get_num_bits_set_portable(ftk_max_mask_size_t mask)
 {
-  uint_fast8_t ret_val = 0;
+  uint64_t count = (uint64_t) mask;
 
-  while(mask != 0)
-  {
-    if(mask & 0x1)
-    {
-      ret_val++;
-    }
+  count = count - ((count >> 1) & 0x5555555555555555ULL);
+  count = (count & 0x3333333333333333ULL) + ((count >> 2) & 0x3333333333333333ULL);
+  count = (count + (count >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
 
-    mask >>= 1;
-  }
-
-  return ret_val;
+  return (uint_fast8_t) ((count * 0x0101010101010101ULL) >> 56);
 }
 
 /**
- * @brief 
- * 
+ * @brief
+ *
  * @param mask Get first set bit (LSB) index from mask
  * @return uint8_t index of first set bit, 0xFF if empty
  */
-uint_fast8_t ftk_get_first_set_bit_idx(ftk_max_mask_size_t mask)
+uint_fast8_t ftk_get_first_set_bit_idx_portable(ftk_max_mask_size_t mask)
 {
-  uint_fast8_t ret_val = 0;
+  uint_fast8_t ret_val = 0xFF;
 
   if(mask != 0)
   {
-    while(0 == (mask & 0x1))
-    {
-      ret_val++;
-      mask >>= 1;
-    }
+    /* Isolate LSB, all bits below it set */
+    ret_val = ftk_get_num_bits_set_portable((mask & (~mask + 1)) - 1);
   }
-  else
+
+  return ret_val;
+}
+
+/**
+ * @brief
+ *
+ * @param mask Get last set bit (MSB) index from mask
+ * @return uint8_t index of last set bit, 0xFF if empty
+ */
+uint_fast8_t ftk_get_last_set_bit_idx_portable(ftk_max_mask_size_t mask)
+{
+  uint64_t fill = (uint64_t) mask;
+
+  if(0 == fill)
   {
-    ret_val = 0xFF;
+    return 0xFF;
   }
 
-  return ret_val;
-}
\ No newline at end of file
+  /* Smear MSB into all lower bits */
+  fill |= fill >> 1;
+  fill |= fill >> 2;
+  fill |= fill >> 4;
+  fill |= fill >> 8;
+  fill |= fill >> 16;
+  fill |= fill >> 32;
+
+  return ftk_get_num_bits_set_portable(fill) - 1;
+}
+
+#ifdef FTK_BITOPS_POPCNT_DISPATCH
+
+#if defined(FTK_BITOPS_BUILTIN)
+__attribute__((target("popcnt")))
+static uint_fast8_t ftk_get_num_bits_set_popcnt(ftk_max_mask_size_t mask)
+{
+  return (uint_fast8_t) __builtin_popcountll(mask);
+}
+
+static bool ftk_cpu_has_popcnt(void)
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("popcnt");
+}
+#elif defined(FTK_BITOPS_MSVC)
+static uint_fast8_t ftk_get_num_bits_set_popcnt(ftk_max_mask_size_t mask)
+{
+  return (uint_fast8_t) __popcnt64(mask);
+}
+
+static bool ftk_cpu_has_popcnt(void)
+{
+  int cpu_info[4];
+  __cpuid(cpu_info, 1);
+  /* CPUID.01H:ECX.POPCNT[bit 23] */
+  return (cpu_info[2] & (1 << 23)) != 0;
+}
+#endif
+
+/**
+ * @brief Portable until resolved.  Only written at library load before any thread can call in
+ *
+ */
+uint_fast8_t (*ftk_get_num_bits_set_impl)(ftk_max_mask_size_t mask) = ftk_get_num_bits_set_portable;
+
+/**
+ * @brief Selects popcount implementation, run once at library load
+ *
+ */
+static void ftk_get_num_bits_set_resolve(void)
+{
+  ftk_get_num_bits_set_impl = ftk_cpu_has_popcnt() ? ftk_get_num_bits_set_popcnt : ftk_get_num_bits_set_portable;
+}
+
+#if defined(FTK_BITOPS_BUILTIN)
+__attribute__((constructor))
+static void ftk_bitops_init(void)
+{
+  ftk_get_num_bits_set_resolve();
+}
+#elif defined(FTK_BITOPS_MSVC)
+/* Run by the CRT with the other C initializers */
+#pragma section(".CRT$XCU", read)
+__declspec(allocate(".CRT$XCU")) static void (*ftk_bitops_init)(void) = ftk_get_num_bits_set_resolve;
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+ farewell_to_king_hash.c
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains implementation of Zobrist position hashing using the generated key tables.
+*/
+
+#include "farewell_to_king_bitops.h"
+#include "farewell_to_king_hash.h"
+#include "farewell_to_king_zobrist.h"
+#include "farewell_to_king_types.h"
+
+ftk_hash_t ftk_hash_piece(ftk_square_s square, ftk_position_t position)
+{
+  /* White rows 0-7, Black rows 8-15 */
+  return ftk_zobrist_piece_table[((square.color >> 1) << 3) | square.type][position];
+}
+
+ftk_hash_t ftk_hash_castle(ftk_castle_mask_t castle_rights)
+{
+  return ftk_zobrist_castle_table[castle_rights & FTK_CASTLE_ALL];
+}
+
+ftk_hash_t ftk_hash_ep(ftk_position_t ep)
+{
+  return (ep < FTK_XX) ? ftk_zobrist_ep_table[ep % 8] : 0;
+}
+
+ftk_hash_t ftk_hash_turn(ftk_color_e turn)
+{
+  return ftk_zobrist_turn_table[turn];
+}
+
+ftk_hash_t ftk_build_hash(const ftk_game_s *game)
+{
+  ftk_board_mask_t pieces = FTK_BOARD_OCCUPIED(&game->board);
+  ftk_hash_t       hash   = ftk_hash_castle(game->castle_rights) ^ ftk_hash_ep(game->ep) ^ ftk_hash_turn(game->turn);
+  ftk_position_t   i;
+
+  while(pieces)
+  {
+    i = ftk_pop_first_set_bit_idx(&pieces);
+    hash ^= ftk_hash_piece(game->board.square[i], i);
+  }
+
+  return hash;
+}
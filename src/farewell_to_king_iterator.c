@@ -0,0 +1,223 @@
+/*
+ farewell_to_king_iterator.c
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Contains implementation of the staged move iterator.
+*/
+
+#include <assert.h>
+
+#include "farewell_to_king.h"
+#include "farewell_to_king_iterator.h"
+#include "farewell_to_king_types.h"
+
+/**
+ * @brief Piece values for capture ordering, indexed by ftk_type_e.  King captures are always legal so never losing
+ *
+ */
+static const int_fast16_t ftk_iterator_piece_value[] = { 0, 1, 3, 3, 5, 9, 0, 0 };
+
+#define FTK_ITERATOR_PROMOTION_RANKS (FTK_RANK_1_MASK | FTK_RANK_8_MASK)
+
+/**
+ * @brief Checks if a move is the hash move, already yielded in the first stage
+ *
+ */
+static bool ftk_iterator_is_hash_move(const ftk_move_iterator_s *iterator, ftk_move16_t move)
+{
+  return (iterator->hash_move & ~FTK_MOVE16_CAPTURE) == (move & ~FTK_MOVE16_CAPTURE);
+}
+
+/**
+ * @brief Checks if a move is a Pawn promotion
+ *
+ */
+static bool ftk_iterator_is_promotion(const ftk_game_s *game, ftk_move16_t move)
+{
+  return (FTK_TYPE_PAWN == game->board.square[FTK_MOVE16_SOURCE(move)].type) &&
+         (FTK_POSITION_TO_MASK(FTK_MOVE16_TARGET(move)) & FTK_ITERATOR_PROMOTION_RANKS);
+}
+
+/**
+ * @brief Checks if hash move is legal in game, only its own source and target are examined
+ *
+ */
+static bool ftk_iterator_hash_move_legal(const ftk_game_s *game, ftk_move16_t move)
+{
+  ftk_type_e promotion = FTK_MOVE16_PROMOTION(move);
+
+  if(false == FTK_MOVE16_VALID(move) ||
+     game->board.square[FTK_MOVE16_SOURCE(move)].color != game->turn)
+  {
+    return false;
+  }
+
+  if(ftk_iterator_is_promotion(game, move))
+  {
+    if((FTK_TYPE_KNIGHT != promotion) && (FTK_TYPE_BISHOP != promotion) &&
+       (FTK_TYPE_ROOK   != promotion) && (FTK_TYPE_QUEEN  != promotion))
+    {
+      return false;
+    }
+  }
+  else if(FTK_TYPE_DONT_CARE != promotion)
+  {
+    return false;
+  }
+
+  return ftk_is_legal_move(game, FTK_MOVE16_SOURCE(move), FTK_MOVE16_TARGET(move), promotion);
+}
+
+/**
+ * @brief Generates captures and promotions.  Winning or even captures sorted most valuable victim first,
+ *        promotions and losing captures saved at the back for their later stages
+ *
+ */
+static void ftk_iterator_generate_captures(ftk_move_iterator_s *iterator)
+{
+  const ftk_board_s *board         = &iterator->game->board;
+  ftk_board_mask_t   opponent_mask = (FTK_COLOR_WHITE == iterator->game->turn) ? board->black_mask : board->white_mask;
+  ftk_move16_t       captures[FTK_MAX_MOVES];
+  ftk_move16_t       promotions[FTK_MAX_MOVES];
+  size_t             capture_count;
+  size_t             k;
+  ftk_position_t     target;
+  ftk_move16_t       move;
+  int_fast16_t       score[FTK_MAX_MOVES];
+  int_fast16_t       victim, attacker;
+  uint_fast16_t      j;
+
+  capture_count = ftk_generate_moves_by_mode(iterator->game, FTK_GEN_CAPTURES, captures, FTK_MAX_MOVES);
+
+  for(k = 0; k < capture_count; k++)
+  {
+    move   = captures[k];
+    target = FTK_MOVE16_TARGET(move);
+
+    if(ftk_iterator_is_hash_move(iterator, move))
+    {
+      continue;
+    }
+
+    if(ftk_iterator_is_promotion(iterator->game, move))
+    {
+      promotions[iterator->promotion_count++] = move;
+      continue;
+    }
+
+    /* En passant target is empty, victim is a Pawn */
+    victim   = ftk_iterator_piece_value[(FTK_TYPE_EMPTY == board->square[target].type) ? FTK_TYPE_PAWN : board->square[target].type];
+    attacker = ftk_iterator_piece_value[board->square[FTK_MOVE16_SOURCE(move)].type];
+
+    assert(iterator->count + iterator->bad_capture_count < FTK_MAX_MOVES);
+
+    /* Defenders only looked up when the capture could lose material */
+    if(victim >= attacker || 0 == (ftk_build_attackers_mask(board, target, FTK_BOARD_OCCUPIED(board)) & opponent_mask))
+    {
+      /* Insert sorted by most valuable victim, then least valuable attacker */
+      for(j = iterator->count; j > 0 && score[j - 1] < (victim * 16 - attacker); j--)
+      {
+        iterator->move[j] = iterator->move[j - 1];
+        score[j]          = score[j - 1];
+      }
+      iterator->move[j] = move;
+      score[j]          = victim * 16 - attacker;
+      iterator->count++;
+    }
+    else
+    {
+      iterator->bad_capture_count++;
+      iterator->move[FTK_MAX_MOVES - iterator->bad_capture_count] = move;
+    }
+  }
+
+  /* Promotions directly in front of the losing captures */
+  for(k = 0; k < iterator->promotion_count; k++)
+  {
+    iterator->move[FTK_MAX_MOVES - iterator->bad_capture_count - iterator->promotion_count + k] = promotions[k];
+  }
+}
+
+/**
+ * @brief Generates all non capturing moves, castling included, in front of the saved losing captures
+ *
+ */
+static void ftk_iterator_generate_quiets(ftk_move_iterator_s *iterator)
+{
+  size_t quiet_count = ftk_generate_moves_by_mode(iterator->game, FTK_GEN_QUIETS, iterator->move,
+                                                  FTK_MAX_MOVES - iterator->bad_capture_count);
+  size_t k;
+
+  assert(quiet_count + iterator->bad_capture_count <= FTK_MAX_MOVES);
+
+  for(k = 0; k < quiet_count; k++)
+  {
+    if(false == ftk_iterator_is_hash_move(iterator, iterator->move[k]))
+    {
+      iterator->move[iterator->count++] = iterator->move[k];
+    }
+  }
+}
+
+void ftk_move_iterator_init(ftk_move_iterator_s *iterator, const ftk_game_s *game, ftk_move16_t hash_move)
+{
+  iterator->game              = game;
+  iterator->stage             = FTK_MOVE_STAGE_HASH;
+  iterator->hash_move         = FTK_MOVE16_INVALID;
+  iterator->index             = 0;
+  iterator->count             = 0;
+  iterator->promotion_count   = 0;
+  iterator->bad_capture_count = 0;
+
+  if(ftk_iterator_hash_move_legal(game, hash_move))
+  {
+    iterator->hash_move = hash_move;
+    iterator->move[iterator->count++] = hash_move;
+  }
+}
+
+bool ftk_move_iterator_next(ftk_move_iterator_s *iterator, ftk_move16_t *move)
+{
+  while(iterator->index >= iterator->count)
+  {
+    if(FTK_MOVE_STAGE_DONE == iterator->stage ||
+       FTK_MOVE_STAGE_BAD_CAPTURES == iterator->stage)
+    {
+      iterator->stage = FTK_MOVE_STAGE_DONE;
+      return false;
+    }
+
+    /* Current stage exhausted, generate next */
+    iterator->stage = (ftk_move_stage_e) (iterator->stage + 1);
+    iterator->index = 0;
+    iterator->count = 0;
+
+    switch(iterator->stage)
+    {
+      case FTK_MOVE_STAGE_GOOD_CAPTURES:
+        ftk_iterator_generate_captures(iterator);
+        break;
+      case FTK_MOVE_STAGE_PROMOTIONS:
+        /* Saved from back of buffer while generating captures */
+        iterator->index = FTK_MAX_MOVES - iterator->bad_capture_count - iterator->promotion_count;
+        iterator->count = FTK_MAX_MOVES - iterator->bad_capture_count;
+        break;
+      case FTK_MOVE_STAGE_QUIETS:
+        ftk_iterator_generate_quiets(iterator);
+        break;
+      case FTK_MOVE_STAGE_BAD_CAPTURES:
+        /* Saved from back of buffer while generating captures */
+        iterator->index = FTK_MAX_MOVES - iterator->bad_capture_count;
+        iterator->count = FTK_MAX_MOVES;
+        break;
+      default:
+        break;
+    }
+  }
+
+  *move = iterator->move[iterator->index++];
+
+  return true;
+}
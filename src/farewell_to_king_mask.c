@@ -7,14 +7,69 @@
  Contains implementation of all methods used to generate and manipulate board masks.
 */
 
-#include <stdlib.h>
+#include <assert.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "farewell_to_king_attack.h"
 #include "farewell_to_king_bitops.h"
 #include "farewell_to_king_mask.h"
 #include "farewell_to_king_types.h"
 
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) && \
+    (defined(__AVX2__) || defined(__SSE2__))
+/* ftk_square_s is one byte: type in bits 0-2, color in bits 3-4, moved in bits 5-6 */
+#define FTK_SQUARE_SIMD
+_Static_assert(sizeof(ftk_square_s) == 1, "SIMD mask build requires one byte squares");
+
+#define FTK_SQUARE_TYPE_BITS  0x07
+#define FTK_SQUARE_COLOR_BITS 0x18
+#define FTK_SQUARE_COLOR_SHIFT 3
+
+#if defined(__AVX2__)
+#define FTK_SIMD_SQUARES                   32
+#define FTK_SIMD_VECTOR                    __m256i
+#define FTK_SIMD_LOAD(squares)             _mm256_loadu_si256((const __m256i *)(squares))
+#define FTK_SIMD_SET(value)                _mm256_set1_epi8((char)(value))
+#define FTK_SIMD_AND(a, b)                 _mm256_and_si256(a, b)
+#define FTK_SIMD_MATCH(a, b)               ((ftk_board_mask_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)))
+#else
+#define FTK_SIMD_SQUARES                   16
+#define FTK_SIMD_VECTOR                    __m128i
+#define FTK_SIMD_LOAD(squares)             _mm_loadu_si128((const __m128i *)(squares))
+#define FTK_SIMD_SET(value)                _mm_set1_epi8((char)(value))
+#define FTK_SIMD_AND(a, b)                 _mm_and_si128(a, b)
+#define FTK_SIMD_MATCH(a, b)               ((ftk_board_mask_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)))
+#endif
+
+/**
+ * @brief Build a board bitmask of squares where (square byte & bits) == value
+ * 
+ */
+static ftk_board_mask_t ftk_build_square_match_mask(const ftk_board_s *board, uint8_t bits, uint8_t value)
+{
+  ftk_board_mask_t mask = 0;
+  FTK_SIMD_VECTOR  bits_vector  = FTK_SIMD_SET(bits);
+  FTK_SIMD_VECTOR  value_vector = FTK_SIMD_SET(value);
+  int i;
+
+  for (i = 0; i < FTK_STD_BOARD_SIZE; i += FTK_SIMD_SQUARES) {
+    mask |= FTK_SIMD_MATCH(FTK_SIMD_AND(FTK_SIMD_LOAD(&board->square[i]), bits_vector), value_vector) << i;
+  }
+
+  return mask;
+}
+#endif
+
 ftk_board_mask_t ftk_build_type_mask(const ftk_board_s *board, ftk_type_e type) 
 {
+#ifdef FTK_SQUARE_SIMD
+  return ftk_build_square_match_mask(board, FTK_SQUARE_TYPE_BITS, (uint8_t) type);
+#else
   ftk_board_mask_t mask = 0;
 
   int i;
@@ -28,10 +83,14 @@ ftk_board_mask_t ftk_build_type_mask(const ftk_board_s *board, ftk_type_e type)
   }
 
   return mask;
+#endif
 }
 
 ftk_board_mask_t ftk_build_color_mask(const ftk_board_s *board, ftk_color_e color) 
 {
+#ifdef FTK_SQUARE_SIMD
+  return ftk_build_square_match_mask(board, FTK_SQUARE_COLOR_BITS, (uint8_t) (color << FTK_SQUARE_COLOR_SHIFT));
+#else
   ftk_board_mask_t mask = 0;
 
   int i;
@@ -45,9 +104,13 @@ ftk_board_mask_t ftk_build_color_mask(const ftk_board_s *board, ftk_color_e colo
   }
 
   return mask;
+#endif
 }
 
 ftk_board_mask_t ftk_build_board_mask(const ftk_board_s *board) {
+#ifdef FTK_SQUARE_SIMD
+  return ~ftk_build_square_match_mask(board, FTK_SQUARE_TYPE_BITS, FTK_TYPE_EMPTY);
+#else
   ftk_board_mask_t mask = 0;
 
   int i;
@@ -60,11 +123,11 @@ ftk_board_mask_t ftk_build_board_mask(const ftk_board_s *board) {
   }
 
   return mask;
+#endif
 }
 
 void ftk_build_all_masks(ftk_board_s *board)
 {
-  board->board_mask = 0;
   board->white_mask = 0;
   board->black_mask = 0;
   board->pawn_mask = 0;
@@ -75,12 +138,38 @@ void ftk_build_all_masks(ftk_board_s *board)
   board->king_mask = 0;
 
   int i;
+#ifdef FTK_SQUARE_SIMD
+  /* Compare a vector of square bytes against each type and color, one movemask per bitboard */
+  FTK_SIMD_VECTOR type_bits  = FTK_SIMD_SET(FTK_SQUARE_TYPE_BITS);
+  FTK_SIMD_VECTOR color_bits = FTK_SIMD_SET(FTK_SQUARE_COLOR_BITS);
+  FTK_SIMD_VECTOR squares, types;
+  ftk_board_mask_t empty = 0;
+
+  for(i = 0; i < FTK_STD_BOARD_SIZE; i += FTK_SIMD_SQUARES)
+  {
+    squares = FTK_SIMD_LOAD(&board->square[i]);
+    types   = FTK_SIMD_AND(squares, type_bits);
+
+    empty              |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_EMPTY))  << i;
+    board->white_mask  |= FTK_SIMD_MATCH(FTK_SIMD_AND(squares, color_bits),
+                                         FTK_SIMD_SET(FTK_COLOR_WHITE << FTK_SQUARE_COLOR_SHIFT)) << i;
+    board->pawn_mask   |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_PAWN))   << i;
+    board->knight_mask |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_KNIGHT)) << i;
+    board->bishop_mask |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_BISHOP)) << i;
+    board->rook_mask   |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_ROOK))   << i;
+    board->queen_mask  |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_QUEEN))  << i;
+    board->king_mask   |= FTK_SIMD_MATCH(types, FTK_SIMD_SET(FTK_TYPE_KING))   << i;
+  }
+
+  /* Empty squares were matched above, any occupied square that is not white is black */
+  board->white_mask &= ~empty;
+  board->black_mask  = ~empty & ~board->white_mask;
+#else
   ftk_board_mask_t biterator = 1ULL;
   for(i=0;i<FTK_STD_BOARD_SIZE;i++)
   {
     if(board->square[i].type != FTK_TYPE_EMPTY)
     {
-      board->board_mask |= biterator;
       if(board->square[i].color == FTK_COLOR_WHITE)
       {
         board->white_mask |= biterator;
@@ -114,194 +203,93 @@ void ftk_build_all_masks(ftk_board_s *board)
     }
     biterator = biterator << 1;
   }
+#endif
 }
 
-ftk_board_mask_t ftk_build_move_mask_raw(ftk_square_s square, ftk_board_mask_t board_mask, ftk_board_mask_t opponent_mask, ftk_position_t position, ftk_position_t *ep)
+/**
+ * @brief Adds setwise generated Pawn targets to the move mask of each source square
+ * 
+ * @param board Board to add moves to
+ * @param targets Target squares
+ * @param offset Target position minus source position
+ */
+static void ftk_scatter_pawn_moves(ftk_move_masks_s *masks, ftk_board_mask_t targets, int offset)
 {
-  ftk_board_mask_t mask = 0;
+  ftk_position_t target;
 
-  if (square.type == FTK_TYPE_PAWN) 
+  while(targets)
   {
-    int direction = (square.color == FTK_COLOR_WHITE)
-                        ? 1
-                        : -1;             // change direction based on color
-    int test = position + direction * 8; // forward/back 1
-
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-        ((board_mask & 1ULL << test) == 0)) {
-      mask |= (1ULL << test);
+    target = ftk_pop_first_set_bit_idx(&targets);
+    masks->move_mask[target - offset] |= FTK_POSITION_TO_MASK(target);
+  }
+}
 
-      test = position + direction * 16; // forward/back 2
+#define FTK_GEN_COLOR_NAME         white
+#define FTK_GEN_COLOR              FTK_COLOR_WHITE
+#define FTK_GEN_OWN_MASK           white_mask
+#define FTK_GEN_OPPONENT_MASK      black_mask
+#define FTK_GEN_SHIFT(mask, n)     ((mask) << (n))
+#define FTK_GEN_PUSH               8
+#define FTK_GEN_CAPTURE_WEST       7
+#define FTK_GEN_CAPTURE_EAST       9
+#define FTK_GEN_DOUBLE_PUSH_RANK   FTK_RANK_3_MASK
+#define FTK_GEN_BACK_RANK          0
+#define FTK_GEN_CASTLE_KING_SIDE   FTK_CASTLE_KING_SIDE_WHITE
+#define FTK_GEN_CASTLE_QUEEN_SIDE  FTK_CASTLE_QUEEN_SIDE_WHITE
+#include "farewell_to_king_mask_gen.h"
+
+#define FTK_GEN_COLOR_NAME         black
+#define FTK_GEN_COLOR              FTK_COLOR_BLACK
+#define FTK_GEN_OWN_MASK           black_mask
+#define FTK_GEN_OPPONENT_MASK      white_mask
+#define FTK_GEN_SHIFT(mask, n)     ((mask) >> -(n))
+#define FTK_GEN_PUSH               -8
+#define FTK_GEN_CAPTURE_WEST       -9
+#define FTK_GEN_CAPTURE_EAST       -7
+#define FTK_GEN_DOUBLE_PUSH_RANK   FTK_RANK_6_MASK
+#define FTK_GEN_BACK_RANK          56
+#define FTK_GEN_CASTLE_KING_SIDE   FTK_CASTLE_KING_SIDE_BLACK
+#define FTK_GEN_CASTLE_QUEEN_SIDE  FTK_CASTLE_QUEEN_SIDE_BLACK
+#include "farewell_to_king_mask_gen.h"
 
-      if ((square.moved == FTK_MOVED_NOT_MOVED) && test < FTK_STD_BOARD_SIZE &&
-          test >= 0 && ((board_mask & 1ULL << test) == 0)) {
-        mask |= (1ULL << test);
-      }
-    }
-    test = position + direction * 9; // capture up-right/down-left diagonal
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-        ((opponent_mask & 1ULL << test) != 0 || test == *ep) &&
-        (1 == abs((test/8) - (position/8)))) 
-    {
-      mask |= (1ULL << test);
-    }
-    test = position + direction * 7; // capture up-left/down-right diagonal
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-        ((opponent_mask & 1ULL << test) != 0 || test == *ep) &&
-        (1 == abs((test/8) - (position/8)))) 
-    {
-      mask |= (1ULL << test);
-    }
+ftk_board_mask_t ftk_build_move_mask_raw(ftk_square_s square, ftk_board_mask_t board_mask, ftk_board_mask_t opponent_mask, ftk_position_t position, ftk_position_t *ep)
+{
+  ftk_board_mask_t mask = 0;
 
+  if (square.type == FTK_TYPE_PAWN) 
+  {
+    mask = (FTK_COLOR_WHITE == square.color) ? ftk_gen_white_pawn_move_mask(board_mask, opponent_mask, position, *ep)
+                                             : ftk_gen_black_pawn_move_mask(board_mask, opponent_mask, position, *ep);
   } 
   else if (square.type == FTK_TYPE_KNIGHT) 
   {
-    // generate mask if square is a knight
-    int test = position + 17;  // up two and right one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) > (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position - 17; // down two and left one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) < (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position + 15; // up two and left one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) < (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position - 15; // down two and right one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) > (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position + 10; // right two and up one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) > (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position - 10; // left two and down one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) < (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position + 6; // left two and up one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) < (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
-    test = position - 6; // right two and down one
-    if (test < FTK_STD_BOARD_SIZE && test >= 0 && (test % 8) > (position % 8) &&
-        ((board_mask & 1ULL << test) == 0 ||
-         (opponent_mask & 1ULL << test) != 0)) {
-      mask |= (1ULL << test);
-    }
+    mask = ftk_knight_attacks(position) & ~(board_mask & ~opponent_mask);
   } 
   else if ((square.type == FTK_TYPE_BISHOP) ||
-             (square.type == FTK_TYPE_ROOK) ||
-             (square.type == FTK_TYPE_QUEEN) ||
-             (square.type == FTK_TYPE_KING)) 
+           (square.type == FTK_TYPE_ROOK) ||
+           (square.type == FTK_TYPE_QUEEN))
   {
-    if (square.type != FTK_TYPE_ROOK) 
+    /* Slider attacks from magic tables, minus squares blocked by own pieces */
+    ftk_board_mask_t own_mask = board_mask & ~opponent_mask;
+
+    if (square.type == FTK_TYPE_BISHOP)
     {
-      int test = position + 9; // up-right diagonal
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             (test % 8) > (position % 8) &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test += 9;
-      }
-      test = position - 9; // down-left diagonal
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             (test % 8) < (position % 8) &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test -= 9;
-      }
-      test = position + 7; // up-left diagonal
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             (test % 8) < (position % 8) &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test += 7;
-      }
-      test = position - 7; // down-right diagonal
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             (test % 8) > (position % 8) &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test -= 7;
-      }
+      mask = ftk_bishop_attacks(position, board_mask);
     }
-    if (square.type != FTK_TYPE_BISHOP) {
-      int test = position + 1; // right horizontal
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             (test % 8) > (position % 8) &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test += 1;
-      }
-      test = position - 1; // left horizontal
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             (test % 8) < (position % 8) &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test -= 1;
-      }
-      test = position + 8; // up vertical
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test += 8;
-      }
-      test = position - 8; // down vertical
-      while (test < FTK_STD_BOARD_SIZE && test >= 0 &&
-             ((board_mask & 1ULL << test) == 0 ||
-              (opponent_mask & 1ULL << test) != 0)) {
-        mask |= (1ULL << test);
-        if (square.type == FTK_TYPE_KING ||
-            (board_mask & 1ULL << test) != 0)
-          break;
-        test -= 8;
-      }
+    else if (square.type == FTK_TYPE_ROOK)
+    {
+      mask = ftk_rook_attacks(position, board_mask);
     }
+    else
+    {
+      mask = ftk_queen_attacks(position, board_mask);
+    }
+
+    mask &= ~own_mask;
+  }
+  else if (square.type == FTK_TYPE_KING) 
+  {
+    mask = ftk_king_attacks(position) & ~(board_mask & ~opponent_mask);
   }
 
   return mask;
@@ -311,373 +299,414 @@ ftk_board_mask_t ftk_build_move_mask(const ftk_board_s *board, ftk_position_t po
   ftk_square_s     square        = board->square[position];
   ftk_board_mask_t opponent_mask = (FTK_COLOR_WHITE == square.color) ? board->black_mask : board->white_mask;
 
-  return ftk_build_move_mask_raw(square, board->board_mask, opponent_mask, position, ep);
+  return ftk_build_move_mask_raw(square, FTK_BOARD_OCCUPIED(board), opponent_mask, position, ep);
+}
+
+void ftk_build_pawn_move_masks(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_color_e color, ftk_position_t ep)
+{
+  if(FTK_COLOR_WHITE == color)
+  {
+    ftk_gen_white_pawn_move_masks(board, masks, ep);
+  }
+  else
+  {
+    ftk_gen_black_pawn_move_masks(board, masks, ep);
+  }
 }
 
 ftk_board_mask_t ftk_build_path_mask(ftk_square_s square, ftk_position_t target, ftk_position_t source, ftk_board_mask_t moves) 
 {
   ftk_board_mask_t mask = 0;
 
-  if ((moves & (1ULL << target)) != 0) 
+  if ((moves & (1ULL << target)) != 0 && square.type != FTK_TYPE_EMPTY) 
   {
-    switch (square.type) 
-    {
-      case FTK_TYPE_PAWN:
-      {
-        if ((target - source) == 16) 
-        {
-          mask = ((1ULL << target) | (1ULL << (target - 8)));
-        } 
-        else if ((source - target) == 16) 
-        {
-          mask = ((1ULL << target) | (1ULL << (target + 8)));
-        } 
-        else 
-        {
-          mask = (1ULL << target);
-        }
-        break;
-      }
-      case FTK_TYPE_KNIGHT:
-      case FTK_TYPE_KING:
-      {
-        mask = (1ULL << target);
-        break;
-      }
-      case FTK_TYPE_BISHOP:
-      case FTK_TYPE_ROOK:
-      case FTK_TYPE_QUEEN:
-      {
-        if (((target/8) != (source/8)) &&
-            ((target%8) != (source%8)) &&
-            (abs(target - source) % 9 == 0))
-        {
-          /* Same diagonal (up/right or down/left) */
-          char i;
-          for (i = target; i > source; i = i - 9)
-            mask |= (1ULL << i);
-
-          for (i = target; i < source; i = i + 9)
-            mask |= (1ULL << i);
-        } 
-        if (((target/8) != (source/8)) &&
-            ((target%8) != (source%8)) &&
-            (abs(target - source) % 7 == 0))
-        {
-          /* Same diagonal (up/left or down/right) */
-          char i;
-          for (i = target; i > source; i = i - 7)
-            mask |= (1ULL << i);
-
-          for (i = target; i < source; i = i + 7)
-            mask |= (1ULL << i);
-        } 
-        if ((target%8) == (source%8))
-        {
-          /* Same file */
-          char i;
-          for (i = target; i > source; i = i - 8)
-            mask |= (1ULL << i);
-          for (i = target; i < source; i = i + 8)
-            mask |= (1ULL << i);
-        } 
-        if((target/8) == (source/8))
-        {
-          /* Same rank */
-          char i;
-          for (i = target; i > source; i = i - 1)
-            mask |= (1ULL << i);
-
-          for (i = target; i < source; i = i + 1)
-            mask |= (1ULL << i);
-        }
-        break;
-      }
-      default:
-      {
-        break;
-      }
-    }
+    /* Knight and single step moves have no squares between source and target */
+    mask = ftk_between_mask(source, target) | FTK_POSITION_TO_MASK(target);
   }
 
   return mask;
 }
 
-ftk_check_e ftk_strip_check(ftk_board_s *board, ftk_color_e turn)
+ftk_board_mask_t ftk_build_attack_mask(const ftk_board_s *board, ftk_color_e color, ftk_board_mask_t occupied)
 {
-  ftk_check_e check = FTK_CHECK_NO_CHECK;
-  ftk_position_t   i,j;
-  ftk_position_t   ep;
-  ftk_board_mask_t temp_mask;
-  ftk_board_mask_t path;
-  ftk_board_mask_t cross;
-  ftk_board_mask_t turn_mask = (FTK_COLOR_WHITE == turn) ? board->white_mask : board->black_mask;
-  ftk_board_mask_t opponent_mask = (FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask;
-  ftk_board_mask_t move_mask_no_opponent;
-  ftk_board_mask_t king_moves_temp;
-  ftk_position_t   protecting;
-  ftk_position_t   king_position;
-  ftk_position_t   move_under_test;
-  int              pawn_direction, pawn_test_square;
-  ftk_board_s      board_copy;
-  king_position = ftk_mask_to_position(board->king_mask & turn_mask);
+  ftk_board_mask_t attack_mask = 0;
+  ftk_board_mask_t color_mask  = (FTK_COLOR_WHITE == color) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t pieces;
+  ftk_position_t   position;
 
-  /* Remove moves cause check or do not resolve check */
-  for (i = 0; i < FTK_STD_BOARD_SIZE; i++) 
+  pieces = board->pawn_mask & color_mask;
+  while(pieces)
   {
-    /* Walk through moves of the entire board */
-    if(board->square[i].type != FTK_TYPE_EMPTY && board->square[i].color != turn)
-    {
-      /* Remove squares that enter check from King's move mask */
-      if(FTK_TYPE_PAWN == board->square[i].type)
-      {
-        /* Ignore forward moves for Pawns as they can only capture diagonally */
-        temp_mask = 0;
-
-        pawn_direction = (board->square[i].color == FTK_COLOR_WHITE) ? 1 : -1; // change direction based on color
-
-        pawn_test_square= i + pawn_direction * 9; // capture up-right/down-left diagonal
-        if (pawn_test_square< FTK_STD_BOARD_SIZE && pawn_test_square>= 0 &&
-            (1 == abs((pawn_test_square/8) - (i/8)))) 
-        {
-          temp_mask |= (1ULL << pawn_test_square);
-        }
-        pawn_test_square= i + pawn_direction * 7; // capture up-left/down-right diagonal
-        if (pawn_test_square< FTK_STD_BOARD_SIZE && pawn_test_square>= 0 &&
-            (1 == abs((pawn_test_square/8) - (i/8)))) 
-        {
-          temp_mask |= (1ULL << pawn_test_square);
-        }
-
-        /* Do not allow King to move into a valid opponent's piece valid move */
-        board->move_mask[king_position] &= ~temp_mask;
-      }
-      else
-      {
-        /* Do not allow King to move into a valid opponent's piece valid move*/
-        board->move_mask[king_position] &= ~board->move_mask[i];
-      }
+    position = ftk_pop_first_set_bit_idx(&pieces);
+    attack_mask |= ftk_pawn_attacks(color, position);
+  }
 
-      /* Square under test is opponents piece */
-      if (board->move_mask[i] & FTK_POSITION_TO_MASK(king_position)) 
-      {
-        /* If opponents piece can move to the King's square, the King is in check */
-        check = FTK_CHECK_IN_CHECK;
-
-        /* Consider opponent's path to king */
-        path = ftk_build_path_mask(board->square[i], king_position, i, board->move_mask[i]);
-        for (j = 0; j < FTK_STD_BOARD_SIZE; j++) 
-        {
-          if(board->square[j].type != FTK_TYPE_EMPTY && board->square[j].type != FTK_TYPE_KING && board->square[j].color == turn)
-          {
-            /* Walk entire board and clear all moves that do not clear check */
-            /* If piece is not the king, remove all moves that do not block check or capture attacker */
-            board->move_mask[j] &= (path | FTK_POSITION_TO_MASK(i));
-          }
-        }
-      }
-      /*Build opponents move mask as if current-turn player's pieces do not exist */
-      move_mask_no_opponent = ftk_build_move_mask_raw(board->square[i], opponent_mask, turn_mask, i, &ep);
+  pieces = board->knight_mask & color_mask;
+  while(pieces)
+  {
+    position = ftk_pop_first_set_bit_idx(&pieces);
+    attack_mask |= ftk_knight_attacks(position);
+  }
 
-      if(move_mask_no_opponent & FTK_POSITION_TO_MASK(king_position))
-      {
-        /* Get opponent's path to players king */
-        path = ftk_build_path_mask(board->square[i], king_position, i, move_mask_no_opponent);
-
-        /* Overlap between piece's path to King and current player's pieces */
-        cross = path & turn_mask;
-        
-        /* Assume no protecting piece */
-        protecting = FTK_XX;
-
-        for (j = 0; j < FTK_STD_BOARD_SIZE; j++) 
-        {
-          if ((cross & FTK_POSITION_TO_MASK(j)) && (board->square[j].type != FTK_TYPE_KING) )
-          {
-            if (protecting != FTK_XX) 
-            {
-              /* If a piece is already blocking, this is the second blocking piece.
-                This is not a potential uncovered check, clear blocking square and break loop */
-              protecting = FTK_XX;
-              break;
-            }
-            /* Piece is protecting King */
-            protecting = j;
-          }
-        }
-        if (protecting != FTK_XX) 
-        {
-          /* If piece is blocking check, only allow moves on the pieces path */
-          board->move_mask[protecting] = board->move_mask[protecting] & (path | FTK_POSITION_TO_MASK(i));
-        }
-      }
-    }
+  pieces = (board->bishop_mask | board->queen_mask) & color_mask;
+  while(pieces)
+  {
+    position = ftk_pop_first_set_bit_idx(&pieces);
+    attack_mask |= ftk_bishop_attacks(position, occupied);
+  }
+
+  pieces = (board->rook_mask | board->queen_mask) & color_mask;
+  while(pieces)
+  {
+    position = ftk_pop_first_set_bit_idx(&pieces);
+    attack_mask |= ftk_rook_attacks(position, occupied);
   }
 
-  /* Verify King cannot move into check with remaining moves */
-  king_moves_temp = board->move_mask[king_position];
-  while(king_moves_temp)
+  pieces = board->king_mask & color_mask;
+  if(pieces)
   {
-    move_under_test = ftk_get_first_set_bit_idx(king_moves_temp);
-    FTK_CLEAR_BIT(king_moves_temp, move_under_test);
+    attack_mask |= ftk_king_attacks(ftk_get_first_set_bit_idx(pieces));
+  }
 
-    board_copy = *board;
-    board_copy.square[move_under_test] = board_copy.square[king_position];
-    FTK_SQUARE_CLEAR(board_copy.square[king_position]);
+  return attack_mask;
+}
 
-    ftk_build_all_masks(&board_copy);
+ftk_board_mask_t ftk_build_attackers_mask(const ftk_board_s *board, ftk_position_t position, ftk_board_mask_t occupied)
+{
+  return (ftk_pawn_attacks(FTK_COLOR_BLACK, position) & board->pawn_mask & board->white_mask) |
+         (ftk_pawn_attacks(FTK_COLOR_WHITE, position) & board->pawn_mask & board->black_mask) |
+         (ftk_knight_attacks(position) & board->knight_mask) |
+         (ftk_king_attacks(position)   & board->king_mask) |
+         (ftk_bishop_attacks(position, occupied) & (board->bishop_mask | board->queen_mask)) |
+         (ftk_rook_attacks(position, occupied)   & (board->rook_mask   | board->queen_mask));
+}
 
-    /* Check all potential (simple) moves to king position after move under test */
-    for(j = 0; j < FTK_STD_BOARD_SIZE; j++)
-    {
-      board_copy.move_mask[j] = ftk_build_move_mask(&board_copy, j, &(ep));
-      if(board_copy.move_mask[j] & FTK_POSITION_TO_MASK(move_under_test))
-      {
-        /* If opponent can move to test square, remove it from King's legal moves */
-        FTK_CLEAR_BIT(board->move_mask[king_position], move_under_test);
-      }
-    }
+ftk_board_mask_t ftk_build_checkers_mask(const ftk_board_s *board, ftk_color_e turn)
+{
+  ftk_board_mask_t turn_mask     = (FTK_COLOR_WHITE == turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t opponent_mask = (FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t king_mask     = board->king_mask & turn_mask;
+
+  if(0 == king_mask)
+  {
+    return 0;
   }
 
-  return check;
+  return ftk_build_attackers_mask(board, ftk_mask_to_position(king_mask), FTK_BOARD_OCCUPIED(board)) & opponent_mask;
+}
+
+void ftk_build_all_attack_masks(const ftk_board_s *board, ftk_move_masks_s *masks)
+{
+  masks->white_attacks = ftk_build_attack_mask(board, FTK_COLOR_WHITE, FTK_BOARD_OCCUPIED(board));
+  masks->black_attacks = ftk_build_attack_mask(board, FTK_COLOR_BLACK, FTK_BOARD_OCCUPIED(board));
+  masks->attacks_valid = true;
 }
 
-void ftk_add_castle(ftk_board_s *board, ftk_color_e turn) 
+/**
+ * @brief Strips King moves onto attacked squares or back along a checking slider's line
+ * 
+ */
+static ftk_board_mask_t ftk_strip_king_moves(const ftk_board_s *board, ftk_position_t king_position, ftk_board_mask_t checkers,
+                                             ftk_board_mask_t attacked, ftk_board_mask_t moves)
 {
-  ftk_castle_mask_t castle = FTK_CASTLE_NONE;
-  ftk_board_mask_t QS;
-  ftk_board_mask_t KS;
-  ftk_position_t i = 0;
+  ftk_board_mask_t pieces = checkers & (board->bishop_mask | board->rook_mask | board->queen_mask);
+  ftk_position_t   i;
 
-  if(turn == FTK_COLOR_WHITE)
+  /* King may not move onto an attacked square */
+  moves &= ~attacked;
+
+  /* King cannot step back along a checking slider's line, the attack map stops at the King */
+  while(pieces)
   {
-    if(FTK_SQUARE_IS(board->square[FTK_E1], FTK_TYPE_KING, FTK_COLOR_WHITE, FTK_MOVED_NOT_MOVED)){
-        /* White King has not moved, consider for castling */
-        castle = FTK_CASTLE_KING_SIDE_WHITE | FTK_CASTLE_QUEEN_SIDE_WHITE;
-    }
+    i = ftk_pop_first_set_bit_idx(&pieces);
+    moves &= ~(ftk_line_mask(king_position, i) & ~FTK_POSITION_TO_MASK(i));
+  }
 
-    QS = FTK_POSITION_TO_MASK(FTK_C1) | FTK_POSITION_TO_MASK(FTK_D1);
-    KS = FTK_POSITION_TO_MASK(FTK_F1) | FTK_POSITION_TO_MASK(FTK_G1);
+  return moves;
+}
 
-    if (((FTK_POSITION_TO_MASK(FTK_B1) | QS) & (board->white_mask | board->black_mask)) != 0 ||
-        !FTK_SQUARE_IS(board->square[FTK_A1], FTK_TYPE_ROOK, FTK_COLOR_WHITE, FTK_MOVED_NOT_MOVED)) 
-    {
-      /* Rook has moved or squared between Rook and King are not emtpy (Queen
-       * side) */
-      castle &= ~FTK_CASTLE_QUEEN_SIDE_WHITE;
-    }
-    if ((KS & (board->white_mask | board->black_mask)) != 0 ||
-        !FTK_SQUARE_IS(board->square[FTK_H1], FTK_TYPE_ROOK, FTK_COLOR_WHITE, FTK_MOVED_NOT_MOVED))
-    {
-      /* Rook has moved or squared between Rook and King are not emtpy (King
-       * side) */
-      castle &= ~FTK_CASTLE_KING_SIDE_WHITE;
-    }
+/**
+ * @brief Build mask of targets resolving check for a piece other than the King
+ * 
+ */
+static ftk_board_mask_t ftk_build_evasion_mask(const ftk_board_s *board, ftk_color_e turn, ftk_position_t ep,
+                                               ftk_position_t king_position, ftk_board_mask_t checkers, bool pawn)
+{
+  ftk_board_mask_t evasion_mask = 0;
+
+  if(1 == ftk_get_num_bits_set(checkers))
+  {
+    /* Block path or capture attacker, in double check only King may move */
+    evasion_mask = ftk_between_mask(king_position, ftk_get_first_set_bit_idx(checkers)) | checkers;
 
-    for(i = 0; i < FTK_STD_BOARD_SIZE && castle != 0; i++)
+    if(pawn && (checkers & board->pawn_mask) && (ep < FTK_XX) &&
+       (FTK_POSITION_TO_MASK(ep) == ((FTK_COLOR_WHITE == turn) ? (checkers << 8) : (checkers >> 8))))
     {
-      /* Check move mask of all black squares if they conflict with white castling */
-      if(board->square[i].color == FTK_COLOR_BLACK)
-      {
-        if (board->move_mask[i] & FTK_POSITION_TO_MASK(FTK_E1))
-        {
-          /* King is in check */
-          castle &= ~FTK_CASTLE_KING_SIDE_WHITE;
-          castle &= ~FTK_CASTLE_QUEEN_SIDE_WHITE;
-        }
-        if (board->move_mask[i] & QS)
-        {
-          /* King passes through check (Queen side) */
-          castle &= ~FTK_CASTLE_QUEEN_SIDE_WHITE;
-        }
-        if (board->move_mask[i] & KS)
-        {
-          /* King passes through check (King side) */
-          castle &= ~FTK_CASTLE_KING_SIDE_WHITE;
-        }
-      }
+      /* Checking Pawn just double stepped, it may be captured en passant */
+      evasion_mask |= FTK_POSITION_TO_MASK(ep);
     }
   }
-  else
+
+  return evasion_mask;
+}
+
+/**
+ * @brief Strips an en passant capture from a Pawn's moves if removing both Pawns from the rank uncovers check
+ * 
+ */
+static ftk_board_mask_t ftk_strip_ep_check(const ftk_board_s *board, ftk_color_e turn, ftk_position_t king_position,
+                                           ftk_board_mask_t opponent_mask, ftk_position_t position, ftk_board_mask_t moves)
+{
+  ftk_board_mask_t ep_captures = moves & ftk_pawn_attacks(turn, position) & ~FTK_BOARD_OCCUPIED(board);
+  ftk_board_mask_t ep_occupied;
+  ftk_position_t   target, captured;
+
+  if(ep_captures)
   {
-    if( FTK_SQUARE_IS(board->square[FTK_E8], FTK_TYPE_KING, FTK_COLOR_BLACK, FTK_MOVED_NOT_MOVED) )
+    target      = ftk_get_first_set_bit_idx(ep_captures);
+    captured    = (FTK_COLOR_WHITE == turn) ? (target - 8) : (target + 8);
+    ep_occupied = (FTK_BOARD_OCCUPIED(board) ^ FTK_POSITION_TO_MASK(position) ^ FTK_POSITION_TO_MASK(captured)) | ep_captures;
+
+    if((ftk_rook_attacks(king_position, ep_occupied)   & (board->rook_mask   | board->queen_mask) & opponent_mask) ||
+       (ftk_bishop_attacks(king_position, ep_occupied) & (board->bishop_mask | board->queen_mask) & opponent_mask))
     {
-      /* Black King has not moved, consider for castling */
-      castle = FTK_CASTLE_KING_SIDE_BLACK | FTK_CASTLE_QUEEN_SIDE_BLACK;
+      moves &= ~ep_captures;
     }
+  }
+
+  return moves;
+}
+
+ftk_check_e ftk_strip_check(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_color_e turn, ftk_position_t ep)
+{
+  ftk_check_e      check = FTK_CHECK_NO_CHECK;
+  ftk_board_mask_t turn_mask = (FTK_COLOR_WHITE == turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t opponent_mask = (FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t king_mask = board->king_mask & turn_mask;
+  ftk_board_mask_t attacked = (FTK_COLOR_WHITE == turn) ? masks->black_attacks : masks->white_attacks;
+  ftk_board_mask_t checkers = 0;
+  ftk_board_mask_t snipers;
+  ftk_board_mask_t blockers;
+  ftk_board_mask_t evasion_mask;
+  ftk_board_mask_t pawn_evasion_mask;
+  ftk_board_mask_t pieces;
+  ftk_position_t   king_position;
+  ftk_position_t   i;
+
+  if(0 == king_mask)
+  {
+    return check;
+  }
+  king_position = ftk_mask_to_position(king_mask);
 
-    QS = FTK_POSITION_TO_MASK(FTK_C8) | FTK_POSITION_TO_MASK(FTK_D8);
-    KS = FTK_POSITION_TO_MASK(FTK_F8) | FTK_POSITION_TO_MASK(FTK_G8);
+  if(attacked & king_mask)
+  {
+    check = FTK_CHECK_IN_CHECK;
+
+    checkers = ftk_build_checkers_mask(board, turn);
 
-    if (((FTK_POSITION_TO_MASK(FTK_B8) | QS) & (board->white_mask | board->black_mask)) != 0 ||
-        !FTK_SQUARE_IS(board->square[FTK_A8], FTK_TYPE_ROOK, FTK_COLOR_BLACK, FTK_MOVED_NOT_MOVED)) 
+    evasion_mask      = ftk_build_evasion_mask(board, turn, ep, king_position, checkers, false);
+    pawn_evasion_mask = ftk_build_evasion_mask(board, turn, ep, king_position, checkers, true);
+
+    pieces = turn_mask & ~king_mask;
+    while(pieces)
     {
-      /* Rook has moved or squared between Rook and King are not emtpy (Queen
-       * side) */
-      castle &= ~FTK_CASTLE_QUEEN_SIDE_BLACK;
+      i = ftk_pop_first_set_bit_idx(&pieces);
+      masks->move_mask[i] &= (board->square[i].type == FTK_TYPE_PAWN) ? pawn_evasion_mask : evasion_mask;
     }
-    if ((KS & (board->white_mask | board->black_mask)) != 0 ||
-        !FTK_SQUARE_IS(board->square[FTK_H8], FTK_TYPE_ROOK, FTK_COLOR_BLACK, FTK_MOVED_NOT_MOVED))
+  }
+
+  masks->move_mask[king_position] = ftk_strip_king_moves(board, king_position, checkers, attacked, masks->move_mask[king_position]);
+
+  /* Opponent sliders lined up with King, a single piece between them is pinned */
+  snipers = ((ftk_rook_attacks(king_position, 0)   & (board->rook_mask   | board->queen_mask)) |
+             (ftk_bishop_attacks(king_position, 0) & (board->bishop_mask | board->queen_mask))) & opponent_mask;
+  while(snipers)
+  {
+    i = ftk_pop_first_set_bit_idx(&snipers);
+
+    blockers = ftk_between_mask(king_position, i) & FTK_BOARD_OCCUPIED(board);
+    if((blockers & turn_mask) && 1 == ftk_get_num_bits_set(blockers))
     {
-      /* Rook has moved or squared between Rook and King are not emtpy (King
-       * side) */
-      castle &= ~FTK_CASTLE_KING_SIDE_BLACK;
+      /* Pinned piece may only move along pin */
+      masks->move_mask[ftk_get_first_set_bit_idx(blockers)] &= ftk_between_mask(king_position, i) | FTK_POSITION_TO_MASK(i);
     }
+  }
+
+  /* En passant removes two pieces from one rank, verify it does not uncover check */
+  pieces = board->pawn_mask & turn_mask;
+  while(pieces)
+  {
+    i = ftk_pop_first_set_bit_idx(&pieces);
+    masks->move_mask[i] = ftk_strip_ep_check(board, turn, king_position, opponent_mask, i, masks->move_mask[i]);
+  }
+
+  return check;
+}
+
+ftk_board_mask_t ftk_build_castle_mask(const ftk_board_s *board, const ftk_move_masks_s *masks, ftk_color_e turn, ftk_castle_mask_t castle_rights)
+{
+  return (FTK_COLOR_WHITE == turn) ? ftk_gen_white_castle_mask(board, castle_rights, masks->black_attacks)
+                                   : ftk_gen_black_castle_mask(board, castle_rights, masks->white_attacks);
+}
 
-    for(i = 0; i < FTK_STD_BOARD_SIZE && castle != 0; i++)
+void ftk_add_castle(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_color_e turn, ftk_castle_mask_t castle_rights) 
+{
+  if(castle_rights & FTK_CASTLE_COLOR(turn))
+  {
+    masks->move_mask[(FTK_COLOR_WHITE == turn) ? FTK_E1 : FTK_E8] |= ftk_build_castle_mask(board, masks, turn, castle_rights);
+  }
+}
+
+/**
+ * @brief Strips moves of a piece other than the King that leave the King in check (not resolving check, breaking a pin, en passant discovered check)
+ * 
+ */
+static ftk_board_mask_t ftk_strip_illegal_moves(const ftk_board_s *board, ftk_color_e turn, ftk_position_t ep, ftk_position_t king_position,
+                                                ftk_board_mask_t checkers, ftk_position_t position, ftk_board_mask_t moves)
+{
+  ftk_board_mask_t position_mask = FTK_POSITION_TO_MASK(position);
+  ftk_board_mask_t opponent_mask = (FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t snipers;
+  ftk_board_mask_t pin;
+  ftk_board_mask_t occupied;
+  ftk_position_t   i;
+  bool             pawn = (FTK_TYPE_PAWN == board->square[position].type);
+
+  if(checkers)
+  {
+    moves &= ftk_build_evasion_mask(board, turn, ep, king_position, checkers, pawn);
+  }
+
+  if(moves && ftk_line_mask(king_position, position))
+  {
+    /* Sliders seen from the King through this piece pin it if this piece is the only one between them */
+    occupied = FTK_BOARD_OCCUPIED(board) ^ position_mask;
+    snipers  = ((ftk_rook_attacks(king_position, occupied)   & (board->rook_mask   | board->queen_mask)) |
+                (ftk_bishop_attacks(king_position, occupied) & (board->bishop_mask | board->queen_mask))) &
+               opponent_mask & ftk_line_mask(king_position, position);
+    while(snipers)
     {
-      /* Check move mask of all white squares if they conflict with black castling */
-      if(board->square[i].color == FTK_COLOR_WHITE)
+      i   = ftk_pop_first_set_bit_idx(&snipers);
+      pin = ftk_between_mask(king_position, i);
+      if(pin & position_mask)
       {
-        if (board->move_mask[i] & FTK_POSITION_TO_MASK(FTK_E8))
-        {
-          /* King is in check */
-          castle &= ~FTK_CASTLE_KING_SIDE_BLACK;
-          castle &= ~FTK_CASTLE_QUEEN_SIDE_BLACK;
-        }
-        if (board->move_mask[i] & QS)
-        {
-          /* King passes through check (Queen side) */
-          castle &= ~FTK_CASTLE_QUEEN_SIDE_BLACK;
-        }
-        if (board->move_mask[i] & KS)
-        {
-          /* King passes through check (King side) */
-          castle &= ~FTK_CASTLE_KING_SIDE_BLACK;
-        }
+        moves &= pin | FTK_POSITION_TO_MASK(i);
       }
     }
   }
-  /* Add castling to King's valid move masks if allowed (Rook already has mask set implicitly) */
-  if(castle & FTK_CASTLE_KING_SIDE_WHITE)
+
+  if(pawn)
+  {
+    moves = ftk_strip_ep_check(board, turn, king_position, opponent_mask, position, moves);
+  }
+
+  return moves;
+}
+
+ftk_board_mask_t ftk_build_legal_move_mask(const ftk_board_s *board, const ftk_move_masks_s *masks, ftk_color_e turn, ftk_position_t ep,
+                                           ftk_castle_mask_t castle_rights, ftk_position_t position)
+{
+  ftk_board_mask_t turn_mask = (FTK_COLOR_WHITE == turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t king_mask = board->king_mask & turn_mask;
+  ftk_board_mask_t moves;
+  ftk_board_mask_t checkers;
+  ftk_position_t   king_position;
+
+  if(0 == (turn_mask & FTK_POSITION_TO_MASK(position)))
   {
-      board->move_mask[FTK_E1] |= FTK_POSITION_TO_MASK(FTK_G1);
+    /* Empty square or opponent piece, basic moves only (opponent may not capture en passant) */
+    ep = FTK_XX;
+    return ftk_build_move_mask(board, position, &ep);
   }
-  if(castle & FTK_CASTLE_QUEEN_SIDE_WHITE)
+
+  moves = ftk_build_move_mask(board, position, &ep);
+
+  if(0 == king_mask)
   {
-      board->move_mask[FTK_E1] |= FTK_POSITION_TO_MASK(FTK_C1);
+    return moves;
   }
-  if(castle & FTK_CASTLE_KING_SIDE_BLACK)
+  king_position = ftk_mask_to_position(king_mask);
+  checkers      = ftk_build_checkers_mask(board, turn);
+
+  if(king_position == position)
   {
-      board->move_mask[FTK_E8] |= FTK_POSITION_TO_MASK(FTK_G8);
+    moves = ftk_strip_king_moves(board, king_position, checkers,
+                                 (FTK_COLOR_WHITE == turn) ? masks->black_attacks : masks->white_attacks, moves);
+
+    if(castle_rights & FTK_CASTLE_COLOR(turn))
+    {
+      moves |= ftk_build_castle_mask(board, masks, turn, castle_rights);
+    }
   }
-  if(castle & FTK_CASTLE_QUEEN_SIDE_BLACK)
+  else
   {
-      board->move_mask[FTK_E8] |= FTK_POSITION_TO_MASK(FTK_C8);
+    moves = ftk_strip_illegal_moves(board, turn, ep, king_position, checkers, position, moves);
   }
+
+  return moves;
 }
 
-ftk_position_t ftk_mask_to_position(ftk_board_mask_t mask)
-{ 
-  ftk_position_t position    = 0; 
-  ftk_board_mask_t temp_mask = mask; 
-  while(temp_mask)
+ftk_board_mask_t ftk_build_legal_targets(const ftk_board_s *board, ftk_color_e turn, ftk_position_t ep, ftk_castle_mask_t castle_rights,
+                                         ftk_position_t position, ftk_board_mask_t targets)
+{
+  ftk_board_mask_t turn_mask     = (FTK_COLOR_WHITE == turn) ? board->white_mask : board->black_mask;
+  ftk_board_mask_t opponent_mask = (FTK_COLOR_WHITE == turn) ? board->black_mask : board->white_mask;
+  ftk_board_mask_t king_mask     = board->king_mask & turn_mask;
+  ftk_board_mask_t castle_path    = FTK_CASTLE_PATH(turn);
+  ftk_board_mask_t castle_targets = FTK_CASTLE_TARGETS(turn);
+  ftk_board_mask_t moves;
+  ftk_board_mask_t attacked = 0;
+  ftk_board_mask_t squares;
+  ftk_position_t   king_position;
+  ftk_position_t   i;
+
+  assert(turn_mask & FTK_POSITION_TO_MASK(position));
+
+  moves = ftk_build_move_mask(board, position, &ep) & targets;
+
+  if(0 == king_mask)
+  {
+    return moves;
+  }
+  king_position = ftk_mask_to_position(king_mask);
+
+  if(king_position != position)
+  {
+    return moves ? ftk_strip_illegal_moves(board, turn, ep, king_position, ftk_build_checkers_mask(board, turn), position, moves) : 0;
+  }
+
+  /* Test each King target with the King removed, no attack masks needed */
+  squares = moves;
+  while(squares)
   {
-    temp_mask >>= 1; 
-    if(temp_mask)
+    i = ftk_pop_first_set_bit_idx(&squares);
+    if(ftk_build_attackers_mask(board, i, FTK_BOARD_OCCUPIED(board) ^ king_mask) & opponent_mask)
     {
-      position++;
-    } 
+      moves &= ~FTK_POSITION_TO_MASK(i);
+    }
   }
-  return position;
+
+  if((targets & castle_targets) && (castle_rights & FTK_CASTLE_COLOR(turn)))
+  {
+    /* Castling only needs attacks on the King's path */
+    squares = castle_path;
+    while(squares)
+    {
+      i = ftk_pop_first_set_bit_idx(&squares);
+      if(ftk_build_attackers_mask(board, i, FTK_BOARD_OCCUPIED(board)) & opponent_mask)
+      {
+        attacked |= FTK_POSITION_TO_MASK(i);
+      }
+    }
+    moves |= targets & ((FTK_COLOR_WHITE == turn) ? ftk_gen_white_castle_mask(board, castle_rights, attacked)
+                                                  : ftk_gen_black_castle_mask(board, castle_rights, attacked));
+  }
+
+  return moves;
+}
+
+ftk_position_t ftk_mask_to_position(ftk_board_mask_t mask)
+{ 
+  return (0 == mask) ? 0 : ftk_get_last_set_bit_idx(mask);
 }
\ No newline at end of file
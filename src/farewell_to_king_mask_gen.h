@@ -0,0 +1,140 @@
+/*
+ farewell_to_king_mask_gen.h
+ Farewell To King - Chess Library
+ Edward Sandor
+ October 2026
+
+ Color specialized move generation template.  Included once per color by farewell_to_king_mask.c
+ with the FTK_GEN_* parameters below defined, producing ftk_gen_white_* and ftk_gen_black_*.
+ All directions and back rank squares are constants so no color branches remain in the generated code.
+
+ FTK_GEN_COLOR_NAME         white/black, used for function names
+ FTK_GEN_COLOR              ftk_color_e of the generating side
+ FTK_GEN_OWN_MASK           ftk_board_s mask of the generating side
+ FTK_GEN_OPPONENT_MASK      ftk_board_s mask of the opponent
+ FTK_GEN_SHIFT(mask, n)     Shift mask n squares towards the opponent
+ FTK_GEN_PUSH               Position offset of a single Pawn push
+ FTK_GEN_CAPTURE_WEST       Position offset of a Pawn capture towards the A file
+ FTK_GEN_CAPTURE_EAST       Position offset of a Pawn capture towards the H file
+ FTK_GEN_DOUBLE_PUSH_RANK   Rank mask of single pushes that may push again
+ FTK_GEN_BACK_RANK          Position offset of back rank from rank 1
+ FTK_GEN_CASTLE_KING_SIDE   ftk_castle_e King side bit
+ FTK_GEN_CASTLE_QUEEN_SIDE  ftk_castle_e Queen side bit
+*/
+
+#define FTK_GEN_CONCAT_(a, b, c) a##b##_##c
+#define FTK_GEN_CONCAT(a, b, c)  FTK_GEN_CONCAT_(a, b, c)
+#define FTK_GEN_FN(name)         FTK_GEN_CONCAT(ftk_gen_, FTK_GEN_COLOR_NAME, name)
+
+#define FTK_GEN_BACK_RANK_MASK(mask) ((mask) << FTK_GEN_BACK_RANK)
+
+/**
+ * @brief Build Pawn move mask for a single Pawn
+ *
+ * @param board_mask Mask of all occupied squares
+ * @param opponent_mask Mask of opponent pieces
+ * @param position Pawn position
+ * @param ep En passant square, FTK_XX if none
+ * @return ftk_board_mask_t
+ */
+static ftk_board_mask_t FTK_GEN_FN(pawn_move_mask)(ftk_board_mask_t board_mask, ftk_board_mask_t opponent_mask, ftk_position_t position, ftk_position_t ep)
+{
+  ftk_board_mask_t single_push = FTK_GEN_SHIFT(FTK_POSITION_TO_MASK(position), FTK_GEN_PUSH) & ~board_mask;
+
+  return single_push |
+         (FTK_GEN_SHIFT(single_push & FTK_GEN_DOUBLE_PUSH_RANK, FTK_GEN_PUSH) & ~board_mask) |
+         (ftk_pawn_attacks(FTK_GEN_COLOR, position) & (opponent_mask | ((ep < FTK_XX) ? FTK_POSITION_TO_MASK(ep) : 0)));
+}
+
+/**
+ * @brief Adds all Pawn moves to the move masks at once
+ *
+ * @param board Board information
+ * @param masks Move masks to add moves to
+ * @param ep En passant square, FTK_XX if none
+ */
+static void FTK_GEN_FN(pawn_move_masks)(const ftk_board_s *board, ftk_move_masks_s *masks, ftk_position_t ep)
+{
+  ftk_board_mask_t pawns        = board->pawn_mask & board->FTK_GEN_OWN_MASK;
+  ftk_board_mask_t empty        = ~FTK_BOARD_OCCUPIED(board);
+  ftk_board_mask_t capture_mask = board->FTK_GEN_OPPONENT_MASK | ((ep < FTK_XX) ? FTK_POSITION_TO_MASK(ep) : 0);
+  ftk_board_mask_t single_push  = FTK_GEN_SHIFT(pawns, FTK_GEN_PUSH) & empty;
+
+  ftk_scatter_pawn_moves(masks, single_push, FTK_GEN_PUSH);
+  ftk_scatter_pawn_moves(masks, FTK_GEN_SHIFT(single_push & FTK_GEN_DOUBLE_PUSH_RANK, FTK_GEN_PUSH) & empty, 2 * FTK_GEN_PUSH);
+  ftk_scatter_pawn_moves(masks, FTK_GEN_SHIFT(pawns & ~FTK_FILE_A_MASK, FTK_GEN_CAPTURE_WEST) & capture_mask, FTK_GEN_CAPTURE_WEST);
+  ftk_scatter_pawn_moves(masks, FTK_GEN_SHIFT(pawns & ~FTK_FILE_H_MASK, FTK_GEN_CAPTURE_EAST) & capture_mask, FTK_GEN_CAPTURE_EAST);
+}
+
+/**
+ * @brief Builds mask of legal castling targets for the King
+ *
+ * @param board Board information
+ * @param castle_rights Remaining castling rights, the King and Rooks are in place for any right held
+ * @param attacked Squares attacked by the opponent, only the King's path is required
+ * @return ftk_board_mask_t
+ */
+static ftk_board_mask_t FTK_GEN_FN(castle_mask)(const ftk_board_s *board, ftk_castle_mask_t castle_rights, ftk_board_mask_t attacked)
+{
+  ftk_board_mask_t  mask   = 0;
+  ftk_castle_mask_t castle = castle_rights & (FTK_GEN_CASTLE_KING_SIDE | FTK_GEN_CASTLE_QUEEN_SIDE);
+  ftk_board_mask_t  QS     = FTK_GEN_BACK_RANK_MASK(FTK_POSITION_TO_MASK(FTK_C1) | FTK_POSITION_TO_MASK(FTK_D1));
+  ftk_board_mask_t  KS     = FTK_GEN_BACK_RANK_MASK(FTK_POSITION_TO_MASK(FTK_F1) | FTK_POSITION_TO_MASK(FTK_G1));
+
+  if (((FTK_GEN_BACK_RANK_MASK(FTK_POSITION_TO_MASK(FTK_B1)) | QS) & FTK_BOARD_OCCUPIED(board)) != 0)
+  {
+    /* Squares between Rook and King are not empty (Queen side) */
+    castle &= ~FTK_GEN_CASTLE_QUEEN_SIDE;
+  }
+  if ((KS & FTK_BOARD_OCCUPIED(board)) != 0)
+  {
+    /* Squares between Rook and King are not empty (King side) */
+    castle &= ~FTK_GEN_CASTLE_KING_SIDE;
+  }
+
+  if (attacked & FTK_POSITION_TO_MASK(FTK_E1 + FTK_GEN_BACK_RANK))
+  {
+    /* King is in check */
+    castle = FTK_CASTLE_NONE;
+  }
+  if (attacked & QS)
+  {
+    /* King passes through check (Queen side) */
+    castle &= ~FTK_GEN_CASTLE_QUEEN_SIDE;
+  }
+  if (attacked & KS)
+  {
+    /* King passes through check (King side) */
+    castle &= ~FTK_GEN_CASTLE_KING_SIDE;
+  }
+
+  /* Castling is a King move (Rook already has mask set implicitly) */
+  if(castle & FTK_GEN_CASTLE_KING_SIDE)
+  {
+    mask |= FTK_POSITION_TO_MASK(FTK_G1 + FTK_GEN_BACK_RANK);
+  }
+  if(castle & FTK_GEN_CASTLE_QUEEN_SIDE)
+  {
+    mask |= FTK_POSITION_TO_MASK(FTK_C1 + FTK_GEN_BACK_RANK);
+  }
+
+  return mask;
+}
+
+#undef FTK_GEN_BACK_RANK_MASK
+#undef FTK_GEN_FN
+#undef FTK_GEN_CONCAT
+#undef FTK_GEN_CONCAT_
+
+#undef FTK_GEN_COLOR_NAME
+#undef FTK_GEN_COLOR
+#undef FTK_GEN_OWN_MASK
+#undef FTK_GEN_OPPONENT_MASK
+#undef FTK_GEN_SHIFT
+#undef FTK_GEN_PUSH
+#undef FTK_GEN_CAPTURE_WEST
+#undef FTK_GEN_CAPTURE_EAST
+#undef FTK_GEN_DOUBLE_PUSH_RANK
+#undef FTK_GEN_BACK_RANK
+#undef FTK_GEN_CASTLE_KING_SIDE
+#undef FTK_GEN_CASTLE_QUEEN_SIDE
@@ -394,34 +394,22 @@ void ftk_game_to_fen_string(const ftk_game_s *game, char *output)
   output[outI] = ' ';
   outI++;
   char castle = 1;
-  if ((FTK_SQUARE_IS(game->board.square[FTK_E1], FTK_TYPE_KING, FTK_COLOR_WHITE,
-                     FTK_MOVED_NOT_MOVED)) &&
-      (FTK_SQUARE_IS(game->board.square[FTK_H1], FTK_TYPE_ROOK, FTK_COLOR_WHITE,
-                     FTK_MOVED_NOT_MOVED))) {
+  if (game->castle_rights & FTK_CASTLE_KING_SIDE_WHITE) {
     output[outI] = 'K';
     outI++;
     castle = 0;
   }
-  if ((FTK_SQUARE_IS(game->board.square[FTK_E1], FTK_TYPE_KING, FTK_COLOR_WHITE,
-                     FTK_MOVED_NOT_MOVED)) &&
-      (FTK_SQUARE_IS(game->board.square[FTK_A1], FTK_TYPE_ROOK, FTK_COLOR_WHITE,
-                     FTK_MOVED_NOT_MOVED))) {
+  if (game->castle_rights & FTK_CASTLE_QUEEN_SIDE_WHITE) {
     output[outI] = 'Q';
     outI++;
     castle = 0;
   }
-  if ((FTK_SQUARE_IS(game->board.square[FTK_E8], FTK_TYPE_KING, FTK_COLOR_BLACK,
-                     FTK_MOVED_NOT_MOVED)) &&
-      (FTK_SQUARE_IS(game->board.square[FTK_H8], FTK_TYPE_ROOK, FTK_COLOR_BLACK,
-                     FTK_MOVED_NOT_MOVED))) {
+  if (game->castle_rights & FTK_CASTLE_KING_SIDE_BLACK) {
     output[outI] = 'k';
     outI++;
     castle = 0;
   }
-  if ((FTK_SQUARE_IS(game->board.square[FTK_E8], FTK_TYPE_KING, FTK_COLOR_BLACK,
-                     FTK_MOVED_NOT_MOVED)) &&
-      (FTK_SQUARE_IS(game->board.square[FTK_A8], FTK_TYPE_ROOK, FTK_COLOR_BLACK,
-                     FTK_MOVED_NOT_MOVED))) {
+  if (game->castle_rights & FTK_CASTLE_QUEEN_SIDE_BLACK) {
     output[outI] = 'q';
     outI++;
     castle = 0;
@@ -540,25 +528,31 @@ ftk_result_e ftk_create_game_from_fen_string(ftk_game_s *game, const char *fen)
 
   if(false == ftk_increment_string_index(fen, &inI, 2)) { return FTK_FAILURE; }
 
+  game->castle_rights = FTK_CASTLE_NONE;
   if(fen[inI] == '-'){
     if(false == ftk_increment_string_index(fen, &inI, 1)) { return FTK_FAILURE; }
   }
   else{
     while(fen[inI] != ' '){
+      /* Moved flags are kept in sync with castling rights for compatibility */
       switch (fen[inI]){
         case 'K':
+          game->castle_rights |= FTK_CASTLE_KING_SIDE_WHITE;
           game->board.square[FTK_E1].moved = FTK_MOVED_NOT_MOVED;
           game->board.square[FTK_H1].moved = FTK_MOVED_NOT_MOVED;
           break;
         case 'Q':
+          game->castle_rights |= FTK_CASTLE_QUEEN_SIDE_WHITE;
           game->board.square[FTK_E1].moved = FTK_MOVED_NOT_MOVED; 
           game->board.square[FTK_A1].moved = FTK_MOVED_NOT_MOVED; 
           break;
         case 'k':
+          game->castle_rights |= FTK_CASTLE_KING_SIDE_BLACK;
           game->board.square[FTK_E8].moved = FTK_MOVED_NOT_MOVED; 
           game->board.square[FTK_H8].moved = FTK_MOVED_NOT_MOVED; 
           break;
         case 'q':
+          game->castle_rights |= FTK_CASTLE_QUEEN_SIDE_BLACK;
           game->board.square[FTK_E8].moved = FTK_MOVED_NOT_MOVED; 
           game->board.square[FTK_A8].moved = FTK_MOVED_NOT_MOVED; 
           break;
@@ -599,6 +593,36 @@ ftk_result_e ftk_create_game_from_fen_string(ftk_game_s *game, const char *fen)
   }
   game->full_move = count;
 
+  /* Castling move generation trusts the rights, drop any whose King or Rook is not in place */
+  if(!FTK_SQUARE_IS(game->board.square[FTK_E1], FTK_TYPE_KING, FTK_COLOR_WHITE, FTK_MOVED_DONT_CARE))
+  {
+    game->castle_rights &= ~FTK_CASTLE_COLOR(FTK_COLOR_WHITE);
+  }
+  if(!FTK_SQUARE_IS(game->board.square[FTK_E8], FTK_TYPE_KING, FTK_COLOR_BLACK, FTK_MOVED_DONT_CARE))
+  {
+    game->castle_rights &= ~FTK_CASTLE_COLOR(FTK_COLOR_BLACK);
+  }
+  if(!FTK_SQUARE_IS(game->board.square[FTK_A1], FTK_TYPE_ROOK, FTK_COLOR_WHITE, FTK_MOVED_DONT_CARE))
+  {
+    game->castle_rights &= ~FTK_CASTLE_QUEEN_SIDE_WHITE;
+  }
+  if(!FTK_SQUARE_IS(game->board.square[FTK_H1], FTK_TYPE_ROOK, FTK_COLOR_WHITE, FTK_MOVED_DONT_CARE))
+  {
+    game->castle_rights &= ~FTK_CASTLE_KING_SIDE_WHITE;
+  }
+  if(!FTK_SQUARE_IS(game->board.square[FTK_A8], FTK_TYPE_ROOK, FTK_COLOR_BLACK, FTK_MOVED_DONT_CARE))
+  {
+    game->castle_rights &= ~FTK_CASTLE_QUEEN_SIDE_BLACK;
+  }
+  if(!FTK_SQUARE_IS(game->board.square[FTK_H8], FTK_TYPE_ROOK, FTK_COLOR_BLACK, FTK_MOVED_DONT_CARE))
+  {
+    game->castle_rights &= ~FTK_CASTLE_KING_SIDE_BLACK;
+  }
+
+  /* Squares were written directly, rebuild piece masks before generating moves */
+  ftk_build_all_masks(&game->board);
+  game->hash = ftk_build_hash(game);
+  ftk_invalidate_game_masks(game);
   ftk_update_board_masks(game);
 
   return ret_val;
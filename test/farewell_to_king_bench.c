@@ -0,0 +1,296 @@
+/*
+ farewell_to_king_bench.c
+ FarewellToKing - Chess Library
+ Edward Sandor
+ October 2026
+
+ Replays a game read from stdin to measure move mask throughput, then searches
+ every position of the game to compare copy-make, make/unmake and pseudo-legal search,
+ and heap against arena move list allocation
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "farewell_to_king.h"
+#include "farewell_to_king_strings.h"
+#include "farewell_to_king_types.h"
+
+#define FTK_BENCH_MAX_MOVES   1024
+#define FTK_BENCH_ITERATIONS  2000
+#define FTK_BENCH_DEPTH       3
+#define FTK_BENCH_ARENA_SIZE  (FTK_BENCH_MAX_MOVES * FTK_MAX_MOVES * sizeof(ftk_move_s))
+
+typedef struct
+{
+  ftk_position_t target;
+  ftk_position_t source;
+  ftk_type_e     pawn_promotion;
+} ftk_bench_move_s;
+
+/**
+ * @brief Generates all legal moves of a game without move masks
+ *
+ */
+static size_t ftk_bench_generate(const ftk_game_s *game, ftk_move16_t *moves)
+{
+  size_t count = ftk_generate_moves_by_mode(game, FTK_GEN_CAPTURES, moves, FTK_MAX_MOVES);
+
+  return count + ftk_generate_moves_by_mode(game, FTK_GEN_QUIETS, &moves[count], FTK_MAX_MOVES - count);
+}
+
+/**
+ * @brief Counts leaf nodes, children are made into a stack copy and dropped on return
+ *
+ */
+static unsigned long ftk_bench_search_copy_make(const ftk_game_s *game, unsigned int depth)
+{
+  ftk_game_s    child;
+  ftk_move16_t  moves[FTK_MAX_MOVES];
+  size_t        count = ftk_bench_generate(game, moves);
+  size_t        i;
+  unsigned long nodes = 0;
+
+  if(depth <= 1)
+  {
+    return count;
+  }
+
+  for(i = 0; i < count; i++)
+  {
+    ftk_position_make_copy(game, moves[i], &child);
+    nodes += ftk_bench_search_copy_make(&child, depth - 1);
+  }
+
+  return nodes;
+}
+
+/**
+ * @brief Counts leaf nodes, children are made in place and unmade from an undo record
+ *
+ */
+static unsigned long ftk_bench_search_make_unmake(ftk_game_s *game, unsigned int depth)
+{
+  ftk_undo_s    undo;
+  ftk_move16_t  moves[FTK_MAX_MOVES];
+  size_t        count = ftk_bench_generate(game, moves);
+  size_t        i;
+  unsigned long nodes = 0;
+
+  if(depth <= 1)
+  {
+    return count;
+  }
+
+  for(i = 0; i < count; i++)
+  {
+    ftk_move16_forward_quick(game, moves[i], &undo);
+    nodes += ftk_bench_search_make_unmake(game, depth - 1);
+    ftk_move16_backward_quick(game, moves[i], &undo);
+  }
+
+  return nodes;
+}
+
+/**
+ * @brief Counts leaf nodes, pseudo-legal moves are only tested for legality when made
+ *
+ */
+static unsigned long ftk_bench_search_pseudo_legal(ftk_game_s *game, unsigned int depth)
+{
+  ftk_undo_s    undo;
+  ftk_move16_t  moves[FTK_MAX_MOVES];
+  size_t        count = ftk_generate_pseudo_legal_moves(game, moves, FTK_MAX_MOVES);
+  size_t        i;
+  unsigned long nodes = 0;
+
+  for(i = 0; i < count; i++)
+  {
+    if(false == ftk_move_is_legal_after_pseudo(game, moves[i]))
+    {
+      continue;
+    }
+
+    if(depth <= 1)
+    {
+      nodes++;
+      continue;
+    }
+
+    ftk_move16_forward_quick(game, moves[i], &undo);
+    nodes += ftk_bench_search_pseudo_legal(game, depth - 1);
+    ftk_move16_backward_quick(game, moves[i], &undo);
+  }
+
+  return nodes;
+}
+
+static uint8_t arena_buffer[FTK_BENCH_ARENA_SIZE];
+
+int main(int argc, char **argv){
+  ftk_game_s       game;
+  ftk_bench_move_s moves[FTK_BENCH_MAX_MOVES];
+  unsigned int     num_moves = 0;
+  unsigned int     iterations = FTK_BENCH_ITERATIONS;
+  unsigned int     depth = FTK_BENCH_DEPTH;
+  unsigned int     i, j;
+  unsigned long    copy_make_nodes = 0, make_unmake_nodes = 0, pseudo_legal_nodes = 0;
+  long             list_moves = 0;
+  ftk_move_list_s  move_list;
+  ftk_arena_s      arena;
+#ifdef FTK_LEAN_BOARD
+  ftk_move_masks_s replay_masks;
+#endif
+  ftk_allocator_s  allocator;
+  char             input[128];
+  clock_t          start;
+  double           seconds;
+
+  if(argc > 1)
+  {
+    iterations = (unsigned int) atoi(argv[1]);
+  }
+  if(argc > 2)
+  {
+    depth = (unsigned int) atoi(argv[2]);
+  }
+
+  while(num_moves < FTK_BENCH_MAX_MOVES && 1 == scanf("%127s", input))
+  {
+    ftk_castle_e castle_type = FTK_CASTLE_NONE;
+
+    moves[num_moves].target         = FTK_XX;
+    moves[num_moves].source         = FTK_XX;
+    moves[num_moves].pawn_promotion = FTK_TYPE_EMPTY;
+
+    if(FTK_SUCCESS == ftk_xboard_move(input, &moves[num_moves].target, &moves[num_moves].source,
+                                      &moves[num_moves].pawn_promotion, &castle_type))
+    {
+      num_moves++;
+    }
+  }
+
+  /* Replay game, every move regenerates all board masks (built into a local copy without stored masks) */
+  start = clock();
+  for(i = 0; i < iterations; i++)
+  {
+    ftk_begin_standard_game(&game);
+    for(j = 0; j < num_moves; j++)
+    {
+      ftk_move_piece(&game, moves[j].target, moves[j].source, moves[j].pawn_promotion);
+#ifdef FTK_LEAN_BOARD
+      ftk_build_move_masks(&game, &replay_masks);
+#endif
+    }
+  }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("replay: %u moves x %u iterations in %.3f s (%.0f moves/s)\r\n",
+         num_moves, iterations, seconds, (seconds > 0) ? (num_moves * iterations) / seconds : 0.0);
+
+  /* Search every position of the game, children copied from an immutable parent */
+  start = clock();
+  ftk_begin_standard_game(&game);
+  for(j = 0; j <= num_moves; j++)
+  {
+    copy_make_nodes += ftk_bench_search_copy_make(&game, depth);
+    if(j < num_moves)
+    {
+      ftk_move_piece_quick(&game, moves[j].target, moves[j].source, moves[j].pawn_promotion);
+    }
+  }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("copy-make: %lu nodes at depth %u in %.3f s (%.0f nodes/s)\r\n",
+         copy_make_nodes, depth, seconds, (seconds > 0) ? copy_make_nodes / seconds : 0.0);
+
+  /* Same search, children made in place and unmade */
+  start = clock();
+  ftk_begin_standard_game(&game);
+  for(j = 0; j <= num_moves; j++)
+  {
+    make_unmake_nodes += ftk_bench_search_make_unmake(&game, depth);
+    if(j < num_moves)
+    {
+      ftk_move_piece_quick(&game, moves[j].target, moves[j].source, moves[j].pawn_promotion);
+    }
+  }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("make/unmake: %lu nodes at depth %u in %.3f s (%.0f nodes/s)\r\n",
+         make_unmake_nodes, depth, seconds, (seconds > 0) ? make_unmake_nodes / seconds : 0.0);
+
+  /* Same search, pseudo-legal moves tested only when made */
+  start = clock();
+  ftk_begin_standard_game(&game);
+  for(j = 0; j <= num_moves; j++)
+  {
+    pseudo_legal_nodes += ftk_bench_search_pseudo_legal(&game, depth);
+    if(j < num_moves)
+    {
+      ftk_move_piece_quick(&game, moves[j].target, moves[j].source, moves[j].pawn_promotion);
+    }
+  }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("pseudo-legal: %lu nodes at depth %u in %.3f s (%.0f nodes/s)\r\n",
+         pseudo_legal_nodes, depth, seconds, (seconds > 0) ? pseudo_legal_nodes / seconds : 0.0);
+
+  /* Move lists of every position of the game, default heap then arena reset once per replay */
+  start = clock();
+  for(i = 0; i < iterations; i++)
+  {
+    ftk_begin_standard_game(&game);
+    for(j = 0; j <= num_moves; j++)
+    {
+      ftk_get_move_list(&game, &move_list);
+      list_moves += move_list.count;
+      ftk_delete_move_list(&move_list);
+      if(j < num_moves)
+      {
+        ftk_move_piece(&game, moves[j].target, moves[j].source, moves[j].pawn_promotion);
+      }
+    }
+  }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("move lists (heap): %u lists x %u iterations in %.3f s\r\n", num_moves + 1, iterations, seconds);
+
+  ftk_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+  ftk_arena_allocator(&arena, &allocator);
+
+  start = clock();
+  for(i = 0; i < iterations; i++)
+  {
+    ftk_begin_standard_game(&game);
+    for(j = 0; j <= num_moves; j++)
+    {
+      ftk_get_move_list_with(&game, &move_list, &allocator);
+      list_moves -= move_list.count;
+      ftk_delete_move_list_with(&move_list, &allocator);
+      if(j < num_moves)
+      {
+        ftk_move_piece(&game, moves[j].target, moves[j].source, moves[j].pawn_promotion);
+      }
+    }
+    ftk_arena_reset(&arena);
+  }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("move lists (arena): %u lists x %u iterations in %.3f s\r\n", num_moves + 1, iterations, seconds);
+
+  if(0 != list_moves)
+  {
+    printf("move list mismatch\r\n");
+    return 1;
+  }
+
+  if(copy_make_nodes != make_unmake_nodes || copy_make_nodes != pseudo_legal_nodes)
+  {
+    printf("node count mismatch\r\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,359 @@
+/*
+ farewell_to_king_perft.c
+ FarewellToKing - Chess Library
+ Edward Sandor
+ October 2026
+
+ Counts leaf nodes of the standard perft positions and compares them against
+ the published counts, plus Pawn check evasion regressions, then cross checks
+ every generation API against the full legal move list in each position of a
+ shallower search.  Returns non zero on any mismatch.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "farewell_to_king.h"
+#include "farewell_to_king_strings.h"
+#include "farewell_to_king_types.h"
+
+#define FTK_PERFT_VERIFY_DEPTH 3
+
+typedef struct
+{
+  const char         *name;
+  const char         *fen;
+  unsigned int        depth;
+  unsigned long long  nodes;
+} ftk_perft_position_s;
+
+static const ftk_perft_position_s ftk_perft_positions[] =
+{
+  { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",                  5, 4865609ULL },
+  { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",      4, 4085603ULL },
+  { "pos3",     "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                 5,  674624ULL },
+  { "pos4",     "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",          4,  422333ULL },
+  { "pos5",     "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                 4, 2103487ULL },
+  { "pos6",     "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL },
+  /* Pawn checks where the square behind the checking Pawn is not the en passant square */
+  { "evasion1", "7k/8/3r4/3pP3/4K3/8/8/8 w - - 0 1",                                        4,    7599ULL },
+  { "evasion2", "1r1q1bnr/pppb2p1/n4k2/3pPp1Q/4P2P/2N5/PPP2PP1/R3KBNR b KQ - 0 11",         4,  184146ULL },
+  { "evasion3", "1B6/4b3/8/P6k/4K1Pp/1r2N1P1/3p4/3Q4 b - - 0 67",                           4,   67344ULL },
+};
+
+/**
+ * @brief Counts leaf nodes with the full move API, bulk counting the last ply
+ *
+ */
+static unsigned long long ftk_perft(ftk_game_s *game, unsigned int depth)
+{
+  ftk_move_s         moves[FTK_MAX_MOVES];
+  ftk_move_s         move;
+  size_t             count = ftk_generate_moves(game, moves, FTK_MAX_MOVES);
+  size_t             i;
+  unsigned long long nodes = 0;
+
+  if(depth <= 1)
+  {
+    return count;
+  }
+
+  for(i = 0; i < count; i++)
+  {
+    move = ftk_move_piece(game, moves[i].target, moves[i].source, moves[i].pawn_promotion);
+    nodes += ftk_perft(game, depth - 1);
+    ftk_move_backward(game, &move);
+  }
+
+  return nodes;
+}
+
+static uint8_t ftk_perft_arena_buffer[FTK_MAX_MOVES * sizeof(ftk_move_s) + FTK_ARENA_ALIGNMENT];
+
+/**
+ * @brief Counts occurrences of a move in a list
+ *
+ */
+static unsigned int ftk_perft_find(const ftk_move16_t *moves, size_t count, ftk_move16_t move)
+{
+  unsigned int found = 0;
+  size_t       i;
+
+  for(i = 0; i < count; i++)
+  {
+    found += (moves[i] == move) ? 1 : 0;
+  }
+
+  return found;
+}
+
+/**
+ * @brief Checks a list holds exactly the legal moves
+ *
+ */
+static bool ftk_perft_same_moves(const ftk_move16_t *legal, size_t legal_count, const ftk_move16_t *moves, size_t count)
+{
+  size_t i;
+
+  if(count != legal_count)
+  {
+    return false;
+  }
+  for(i = 0; i < count; i++)
+  {
+    if(1 != ftk_perft_find(moves, count, legal[i]))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reports a failed check with the position it failed in
+ *
+ */
+static unsigned int ftk_perft_fail(const ftk_game_s *game, const char *check)
+{
+  char fen[128];
+
+  ftk_game_to_fen_string(game, fen);
+  printf("%s mismatch in %s\r\n", check, fen);
+
+  return 1;
+}
+
+/**
+ * @brief Cross checks generation modes, pseudo-legal generation, legality query, iterator, copy-make,
+ *        hash and arena move lists against the full legal move list of a position
+ *
+ */
+static unsigned int ftk_perft_verify_position(ftk_game_s *game)
+{
+  ftk_move_s           moves[FTK_MAX_MOVES];
+  ftk_move16_t         legal[FTK_MAX_MOVES];
+  ftk_move16_t         captures[FTK_MAX_MOVES], quiets[FTK_MAX_MOVES], evasions[FTK_MAX_MOVES], checks[FTK_MAX_MOVES];
+  ftk_move16_t         pseudo[FTK_MAX_MOVES], modes[2 * FTK_MAX_MOVES];
+  size_t               count, capture_count, quiet_count, evasion_count, check_count, pseudo_count, pseudo_legal = 0;
+  size_t               expected_checks = 0, i;
+  ftk_move_iterator_s  iterator;
+  ftk_move16_t         move16;
+  ftk_move_s           move;
+  ftk_game_s           child;
+  ftk_move_list_s      move_list;
+  ftk_arena_s          arena;
+  ftk_allocator_s      allocator;
+  ftk_position_t       source, target;
+  ftk_board_mask_t     pieces;
+  bool                 expected, same;
+  unsigned int         failures = 0;
+
+  count = ftk_generate_moves(game, moves, FTK_MAX_MOVES);
+  for(i = 0; i < count; i++)
+  {
+    legal[i] = ftk_move_to_move16(&moves[i]);
+  }
+
+  if(ftk_build_hash(game) != game->hash)
+  {
+    failures += ftk_perft_fail(game, "hash");
+  }
+
+  /* Captures and quiets partition the legal moves */
+  capture_count = ftk_generate_moves_by_mode(game, FTK_GEN_CAPTURES, captures, FTK_MAX_MOVES);
+  quiet_count   = ftk_generate_moves_by_mode(game, FTK_GEN_QUIETS, quiets, FTK_MAX_MOVES);
+  for(i = 0; i < capture_count; i++)
+  {
+    modes[i] = captures[i];
+  }
+  for(i = 0; i < quiet_count; i++)
+  {
+    modes[capture_count + i] = quiets[i];
+  }
+  if(false == ftk_perft_same_moves(legal, count, modes, capture_count + quiet_count))
+  {
+    failures += ftk_perft_fail(game, "captures/quiets");
+  }
+
+  /* Evasions are every legal move when in check, none otherwise */
+  evasion_count = ftk_generate_moves_by_mode(game, FTK_GEN_EVASIONS, evasions, FTK_MAX_MOVES);
+  if((FTK_CHECK_IN_CHECK == ftk_check_for_check(game)) ? (false == ftk_perft_same_moves(legal, count, evasions, evasion_count)) : (0 != evasion_count))
+  {
+    failures += ftk_perft_fail(game, "evasions");
+  }
+
+  /* Quiet checks are exactly the quiet moves giving check */
+  check_count = ftk_generate_moves_by_mode(game, FTK_GEN_QUIET_CHECKS, checks, FTK_MAX_MOVES);
+  for(i = 0; i < quiet_count; i++)
+  {
+    ftk_position_make_copy(game, quiets[i], &child);
+    if(FTK_CHECK_IN_CHECK == ftk_check_for_check(&child))
+    {
+      expected_checks++;
+      if(1 != ftk_perft_find(checks, check_count, quiets[i]))
+      {
+        failures += ftk_perft_fail(game, "quiet checks");
+      }
+    }
+  }
+  if(expected_checks != check_count)
+  {
+    failures += ftk_perft_fail(game, "quiet check count");
+  }
+
+  /* Pseudo-legal moves passing the deferred test are the legal moves */
+  pseudo_count = ftk_generate_pseudo_legal_moves(game, pseudo, FTK_MAX_MOVES);
+  for(i = 0; i < pseudo_count; i++)
+  {
+    if(ftk_move_is_legal_after_pseudo(game, pseudo[i]))
+    {
+      pseudo[pseudo_legal++] = pseudo[i];
+    }
+  }
+  if(false == ftk_perft_same_moves(legal, count, pseudo, pseudo_legal))
+  {
+    failures += ftk_perft_fail(game, "pseudo-legal");
+  }
+
+  /* Legality query agrees with the generated moves for every source and target of the side to move */
+  pieces = (FTK_COLOR_WHITE == game->turn) ? game->board.white_mask : game->board.black_mask;
+  while(pieces)
+  {
+    source = ftk_pop_first_set_bit_idx(&pieces);
+    for(target = 0; target < FTK_STD_BOARD_SIZE; target++)
+    {
+      expected = false;
+      for(i = 0; i < count; i++)
+      {
+        expected = expected || (FTK_MOVE16_SOURCE(legal[i]) == source && FTK_MOVE16_TARGET(legal[i]) == target);
+      }
+      if(ftk_is_legal_move(game, source, target, FTK_TYPE_DONT_CARE) != expected)
+      {
+        failures += ftk_perft_fail(game, "legality query");
+      }
+    }
+  }
+
+  /* Iterator yields the hash move first, then every other legal move once */
+  ftk_move_iterator_init(&iterator, game, (count > 0) ? legal[count / 2] : FTK_MOVE16_INVALID);
+  for(i = 0; ftk_move_iterator_next(&iterator, &move16); i++)
+  {
+    if(i >= count || 1 != ftk_perft_find(legal, count, move16) || (0 == i && move16 != legal[count / 2]))
+    {
+      failures += ftk_perft_fail(game, "iterator");
+      break;
+    }
+  }
+  if(i != count)
+  {
+    failures += ftk_perft_fail(game, "iterator count");
+  }
+
+  /* Copy-make children match make/unmake, hashes included */
+  for(i = 0; i < count; i++)
+  {
+    ftk_position_make_copy(game, legal[i], &child);
+    move = ftk_move_piece_quick(game, moves[i].target, moves[i].source, moves[i].pawn_promotion);
+    same = (0 == memcmp(child.board.square, game->board.square, sizeof(child.board.square))) &&
+           child.ep == game->ep && child.turn == game->turn && child.castle_rights == game->castle_rights &&
+           child.hash == game->hash && child.hash == ftk_build_hash(&child);
+    ftk_move_backward(game, &move);
+    if(false == same)
+    {
+      failures += ftk_perft_fail(game, "copy-make");
+    }
+  }
+
+  /* Arena move lists match the legal moves */
+  ftk_arena_init(&arena, ftk_perft_arena_buffer, sizeof(ftk_perft_arena_buffer));
+  ftk_arena_allocator(&arena, &allocator);
+  ftk_get_move_list_with(game, &move_list, &allocator);
+  if(move_list.count != count || NULL == move_list.move || 0 != ((uintptr_t) move_list.move % FTK_ARENA_ALIGNMENT))
+  {
+    failures += ftk_perft_fail(game, "arena move list");
+  }
+  ftk_delete_move_list_with(&move_list, &allocator);
+
+  return failures;
+}
+
+/**
+ * @brief Verifies every position of a search
+ *
+ */
+static unsigned int ftk_perft_verify(ftk_game_s *game, unsigned int depth)
+{
+  ftk_move_s   moves[FTK_MAX_MOVES];
+  ftk_move_s   move;
+  size_t       count = ftk_generate_moves(game, moves, FTK_MAX_MOVES);
+  size_t       i;
+  unsigned int failures = ftk_perft_verify_position(game);
+
+  for(i = 0; depth > 1 && i < count && 0 == failures; i++)
+  {
+    move = ftk_move_piece(game, moves[i].target, moves[i].source, moves[i].pawn_promotion);
+    failures += ftk_perft_verify(game, depth - 1);
+    ftk_move_backward(game, &move);
+  }
+
+  return failures;
+}
+
+/**
+ * @brief Checks heap games are aligned, from the default allocator and from an arena
+ *
+ */
+static unsigned int ftk_perft_verify_new_game(void)
+{
+  ftk_arena_s      arena;
+  ftk_allocator_s  allocator;
+  ftk_game_s      *game;
+  unsigned int     failures = 0;
+
+  /* Offset buffer, only the game allocation may realign it */
+  ftk_arena_init(&arena, &ftk_perft_arena_buffer[1], sizeof(ftk_perft_arena_buffer) - 1);
+  ftk_arena_allocator(&arena, &allocator);
+
+  game = ftk_new_game(NULL);
+  failures += (NULL == game || 0 != ((uintptr_t) game % FTK_BOARD_ALIGNMENT)) ? 1 : 0;
+  ftk_delete_game(game, NULL);
+
+  game = ftk_new_game(&allocator);
+  failures += (NULL == game || 0 != ((uintptr_t) game % FTK_BOARD_ALIGNMENT)) ? 1 : 0;
+  ftk_delete_game(game, &allocator);
+
+  if(failures)
+  {
+    printf("game alignment mismatch\r\n");
+  }
+
+  return failures;
+}
+
+int main(void)
+{
+  ftk_game_s         game;
+  unsigned long long nodes;
+  size_t             i;
+  int                failures = (int) ftk_perft_verify_new_game();
+
+  for(i = 0; i < sizeof(ftk_perft_positions)/sizeof(ftk_perft_positions[0]); i++)
+  {
+    ftk_create_game_from_fen_string(&game, ftk_perft_positions[i].fen);
+
+    nodes = ftk_perft(&game, ftk_perft_positions[i].depth);
+
+    printf("%s: depth %u %llu nodes (expected %llu) %s\r\n", ftk_perft_positions[i].name, ftk_perft_positions[i].depth,
+           nodes, ftk_perft_positions[i].nodes, (nodes == ftk_perft_positions[i].nodes) ? "ok" : "FAIL");
+
+    if(nodes != ftk_perft_positions[i].nodes)
+    {
+      failures++;
+    }
+
+    failures += (int) ftk_perft_verify(&game, FTK_PERFT_VERIFY_DEPTH);
+  }
+
+  return failures;
+}
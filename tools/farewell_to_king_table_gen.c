@@ -0,0 +1,480 @@
+/*
+ farewell_to_king_table_gen.c
+ FarewellToKing - Chess Library
+ Edward Sandor
+ October 2026
+
+ Build time generator for the static attack tables in farewell_to_king_tables.h and the Zobrist
+ key tables in farewell_to_king_zobrist.h
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FTK_GEN_BOARD_SIZE 64
+
+typedef uint64_t ftk_gen_mask_t;
+
+/**
+ * @brief Rook magic multipliers, mapping relevant blockers to a unique attack table index
+ *
+ */
+static const ftk_gen_mask_t ftk_gen_rook_magic_numbers[FTK_GEN_BOARD_SIZE] =
+{
+  0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+  0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+  0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+  0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+  0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+  0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+  0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+  0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+  0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+  0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+  0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+  0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+  0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+  0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+  0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+  0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL,
+};
+
+/**
+ * @brief Bishop magic multipliers, mapping relevant blockers to a unique attack table index
+ *
+ */
+static const ftk_gen_mask_t ftk_gen_bishop_magic_numbers[FTK_GEN_BOARD_SIZE] =
+{
+  0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+  0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+  0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+  0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+  0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+  0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+  0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+  0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+  0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+  0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+  0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+  0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+  0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+  0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+  0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+  0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL,
+};
+
+static const int ftk_gen_rook_rank_step[4]   = { 1, -1,  0,  0};
+static const int ftk_gen_rook_file_step[4]   = { 0,  0,  1, -1};
+static const int ftk_gen_bishop_rank_step[4] = { 1,  1, -1, -1};
+static const int ftk_gen_bishop_file_step[4] = { 1, -1,  1, -1};
+
+static bool ftk_gen_on_board(int rank, int file)
+{
+  return (rank >= 0 && rank < 8 && file >= 0 && file < 8);
+}
+
+static ftk_gen_mask_t ftk_gen_bit(int rank, int file)
+{
+  return ftk_gen_on_board(rank, file) ? (1ULL << (rank * 8 + file)) : 0;
+}
+
+static int ftk_gen_num_bits_set(ftk_gen_mask_t mask)
+{
+  int count = 0;
+
+  while(mask)
+  {
+    mask &= mask - 1;
+    count++;
+  }
+
+  return count;
+}
+
+/**
+ * @brief Walks slider rays from a position one square at a time
+ *
+ * @param edge true to exclude the last square of each ray (relevant blocker mask)
+ */
+static ftk_gen_mask_t ftk_gen_ray_mask(int position, ftk_gen_mask_t occupied, bool bishop, bool edge)
+{
+  const int *rank_step = bishop ? ftk_gen_bishop_rank_step : ftk_gen_rook_rank_step;
+  const int *file_step = bishop ? ftk_gen_bishop_file_step : ftk_gen_rook_file_step;
+  ftk_gen_mask_t mask = 0;
+  int direction, rank, file;
+
+  for(direction = 0; direction < 4; direction++)
+  {
+    rank = (position / 8) + rank_step[direction];
+    file = (position % 8) + file_step[direction];
+
+    while(ftk_gen_on_board(rank, file))
+    {
+      if(edge && !ftk_gen_on_board(rank + rank_step[direction], file + file_step[direction]))
+      {
+        break;
+      }
+
+      mask |= ftk_gen_bit(rank, file);
+
+      if(!edge && (occupied & ftk_gen_bit(rank, file)))
+      {
+        break;
+      }
+
+      rank += rank_step[direction];
+      file += file_step[direction];
+    }
+  }
+
+  return mask;
+}
+
+static void ftk_gen_print_mask_array(FILE *out, const char *type, const char *name, const ftk_gen_mask_t *table, int size)
+{
+  int i;
+
+  fprintf(out, "static const %s %s[%d] =\n{\n", type, name, size);
+  for(i = 0; i < size; i++)
+  {
+    fprintf(out, "%s0x%016llXULL,%s", (i % 4) ? " " : "  ", (unsigned long long) table[i], ((i % 4) == 3) ? "\n" : "");
+  }
+  if(size % 4)
+  {
+    fprintf(out, "\n");
+  }
+  fprintf(out, "};\n\n");
+}
+
+static void ftk_gen_print_mask_array_2d(FILE *out, const char *type, const char *name, ftk_gen_mask_t table[][FTK_GEN_BOARD_SIZE], int rows)
+{
+  int i, j;
+
+  fprintf(out, "static const %s %s[%d][%d] =\n{\n", type, name, rows, FTK_GEN_BOARD_SIZE);
+  for(i = 0; i < rows; i++)
+  {
+    fprintf(out, "  {\n");
+    for(j = 0; j < FTK_GEN_BOARD_SIZE; j++)
+    {
+      fprintf(out, "%s0x%016llXULL,%s", (j % 4) ? " " : "    ", (unsigned long long) table[i][j], ((j % 4) == 3) ? "\n" : "");
+    }
+    fprintf(out, "  },\n");
+  }
+  fprintf(out, "};\n\n");
+}
+
+/**
+ * @brief Opens a temporary file next to the output, renamed over it by ftk_gen_close() on success
+ *
+ */
+static FILE *ftk_gen_open(const char *path, char *temp_path, size_t temp_size)
+{
+  FILE *out;
+
+  if(snprintf(temp_path, temp_size, "%s.tmp", path) >= (int) temp_size)
+  {
+    fprintf(stderr, "path too long %s\n", path);
+    return NULL;
+  }
+
+  out = fopen(temp_path, "w");
+  if(NULL == out)
+  {
+    fprintf(stderr, "unable to open %s\n", temp_path);
+  }
+
+  return out;
+}
+
+/**
+ * @brief Closes a temporary file, replacing the output with it if nothing failed and removing it otherwise
+ *
+ * @return int 0 on success, non-zero on failure
+ */
+static int ftk_gen_close(FILE *out, const char *temp_path, const char *path, int result)
+{
+  if(ferror(out))
+  {
+    fprintf(stderr, "unable to write %s\n", temp_path);
+    result = 1;
+  }
+  if(0 != fclose(out))
+  {
+    result = 1;
+  }
+
+  if(result)
+  {
+    remove(temp_path);
+    return result;
+  }
+
+  /* rename() does not replace an existing file on every platform */
+  remove(path);
+  if(0 != rename(temp_path, path))
+  {
+    fprintf(stderr, "unable to rename %s to %s\n", temp_path, path);
+    remove(temp_path);
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Fixed seed generator (SplitMix64) for Zobrist keys, identical keys on every build
+ *
+ */
+static ftk_gen_mask_t ftk_gen_random(ftk_gen_mask_t *state)
+{
+  ftk_gen_mask_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief Generates magic parameter and attack tables for one slider type
+ *
+ * @return int 0 on success, non-zero if a magic number produces a destructive collision
+ */
+static int ftk_gen_magic(FILE *out, const char *name, const ftk_gen_mask_t *magic_numbers, bool bishop)
+{
+  static ftk_gen_mask_t attacks[FTK_GEN_BOARD_SIZE * 4096];
+  static bool           used[FTK_GEN_BOARD_SIZE * 4096];
+  ftk_gen_mask_t mask[FTK_GEN_BOARD_SIZE];
+  unsigned int   offset[FTK_GEN_BOARD_SIZE];
+  int            shift[FTK_GEN_BOARD_SIZE];
+  unsigned int   size = 0;
+  int            position;
+  char           table_name[64];
+
+  memset(used, 0, sizeof(used));
+
+  for(position = 0; position < FTK_GEN_BOARD_SIZE; position++)
+  {
+    ftk_gen_mask_t subset = 0;
+
+    mask[position]   = ftk_gen_ray_mask(position, 0, bishop, true);
+    shift[position]  = 64 - ftk_gen_num_bits_set(mask[position]);
+    offset[position] = size;
+
+    /* Carry-Rippler walk through every subset of relevant blockers */
+    do
+    {
+      unsigned int   index  = size + (unsigned int)((subset * magic_numbers[position]) >> shift[position]);
+      ftk_gen_mask_t attack = ftk_gen_ray_mask(position, subset, bishop, false);
+
+      if(used[index] && attacks[index] != attack)
+      {
+        fprintf(stderr, "%s magic collision on square %d\n", name, position);
+        return 1;
+      }
+      used[index]    = true;
+      attacks[index] = attack;
+
+      subset = (subset - mask[position]) & mask[position];
+    } while(subset);
+
+    size += 1U << (64 - shift[position]);
+  }
+
+  snprintf(table_name, sizeof(table_name), "ftk_%s_attack_table", name);
+  ftk_gen_print_mask_array(out, "ftk_board_mask_t", table_name, attacks, (int) size);
+
+  fprintf(out, "static const ftk_magic_s ftk_%s_magic[%d] =\n{\n", name, FTK_GEN_BOARD_SIZE);
+  for(position = 0; position < FTK_GEN_BOARD_SIZE; position++)
+  {
+    fprintf(out, "  {0x%016llXULL, 0x%016llXULL, %6u, %2d},\n",
+            (unsigned long long) mask[position], (unsigned long long) magic_numbers[position], offset[position], shift[position]);
+  }
+  fprintf(out, "};\n\n");
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  static const int knight_rank_step[8] = { 2,  2, -2, -2,  1,  1, -1, -1};
+  static const int knight_file_step[8] = { 1, -1,  1, -1,  2, -2,  2, -2};
+  static ftk_gen_mask_t between[FTK_GEN_BOARD_SIZE][FTK_GEN_BOARD_SIZE];
+  static ftk_gen_mask_t line[FTK_GEN_BOARD_SIZE][FTK_GEN_BOARD_SIZE];
+  ftk_gen_mask_t knight[FTK_GEN_BOARD_SIZE];
+  ftk_gen_mask_t king[FTK_GEN_BOARD_SIZE];
+  ftk_gen_mask_t pawn[2][FTK_GEN_BOARD_SIZE];
+  /* Zobrist keys, pieces indexed by (color >> 1) * 8 + type, rows of empty and invalid types stay zero */
+  static ftk_gen_mask_t zobrist_piece[16][FTK_GEN_BOARD_SIZE];
+  ftk_gen_mask_t zobrist_castle[16];
+  ftk_gen_mask_t zobrist_ep[8];
+  ftk_gen_mask_t zobrist_turn[4] = { 0, 0, 0, 0 };
+  ftk_gen_mask_t castle_right[4];
+  ftk_gen_mask_t seed = 0x46544B5A4F425249ULL;
+  int            position, target, i, rank, file;
+  int            result = 0;
+  FILE          *out;
+  char           temp_path[FILENAME_MAX];
+
+  if(argc != 3)
+  {
+    fprintf(stderr, "usage: %s <tables header> <zobrist header>\n", argv[0]);
+    return 1;
+  }
+
+  for(position = 0; position < FTK_GEN_BOARD_SIZE; position++)
+  {
+    rank = position / 8;
+    file = position % 8;
+
+    knight[position] = 0;
+    king[position]   = 0;
+    for(i = 0; i < 8; i++)
+    {
+      knight[position] |= ftk_gen_bit(rank + knight_rank_step[i], file + knight_file_step[i]);
+    }
+    for(i = 0; i < 4; i++)
+    {
+      king[position] |= ftk_gen_bit(rank + ftk_gen_rook_rank_step[i],   file + ftk_gen_rook_file_step[i]);
+      king[position] |= ftk_gen_bit(rank + ftk_gen_bishop_rank_step[i], file + ftk_gen_bishop_file_step[i]);
+    }
+    pawn[0][position] = ftk_gen_bit(rank + 1, file - 1) | ftk_gen_bit(rank + 1, file + 1);
+    pawn[1][position] = ftk_gen_bit(rank - 1, file - 1) | ftk_gen_bit(rank - 1, file + 1);
+
+    for(target = 0; target < FTK_GEN_BOARD_SIZE; target++)
+    {
+      ftk_gen_mask_t position_mask = 1ULL << position;
+      ftk_gen_mask_t target_mask   = 1ULL << target;
+      bool           bishop;
+
+      between[position][target] = 0;
+      line[position][target]    = 0;
+
+      if(position == target)
+      {
+        continue;
+      }
+
+      for(bishop = false; ; bishop = true)
+      {
+        if(ftk_gen_ray_mask(position, 0, bishop, false) & target_mask)
+        {
+          /* Aligned, rays from both ends overlap only along the shared line */
+          between[position][target] = ftk_gen_ray_mask(position, target_mask, bishop, false) &
+                                      ftk_gen_ray_mask(target, position_mask, bishop, false);
+          line[position][target]    = (ftk_gen_ray_mask(position, 0, bishop, false) &
+                                       ftk_gen_ray_mask(target, 0, bishop, false)) |
+                                      position_mask | target_mask;
+        }
+        if(bishop)
+        {
+          break;
+        }
+      }
+    }
+  }
+
+  for(i = 0; i < 16; i++)
+  {
+    for(position = 0; position < FTK_GEN_BOARD_SIZE; position++)
+    {
+      /* Types Pawn (1) through King (6) */
+      zobrist_piece[i][position] = ((i % 8) >= 1 && (i % 8) <= 6) ? ftk_gen_random(&seed) : 0;
+    }
+  }
+  for(i = 0; i < 4; i++)
+  {
+    castle_right[i] = ftk_gen_random(&seed);
+  }
+  for(i = 0; i < 16; i++)
+  {
+    /* Each castling rights combination hashes as the sum of its rights */
+    zobrist_castle[i] = 0;
+    for(rank = 0; rank < 4; rank++)
+    {
+      zobrist_castle[i] ^= (i & (1 << rank)) ? castle_right[rank] : 0;
+    }
+  }
+  for(i = 0; i < 8; i++)
+  {
+    zobrist_ep[i] = ftk_gen_random(&seed);
+  }
+  /* Black (2) to move */
+  zobrist_turn[2] = ftk_gen_random(&seed);
+
+  /* Written to temporary files and renamed on success, a failed run never leaves a partial header behind */
+  out = ftk_gen_open(argv[1], temp_path, sizeof(temp_path));
+  if(NULL == out)
+  {
+    return 1;
+  }
+
+  fprintf(out, "/*\n"
+               " farewell_to_king_tables.h\n"
+               " Farewell To King - Chess Library\n"
+               "\n"
+               " Generated by farewell_to_king_table_gen.c at build time, do not edit.\n"
+               "*/\n\n"
+               "#ifndef _FAREWELL_TO_KING_TABLES_H_\n"
+               "#define _FAREWELL_TO_KING_TABLES_H_\n"
+               "#include \"farewell_to_king_types.h\"\n\n"
+               "/**\n"
+               " * @brief Magic bitboard lookup parameters for a single square\n"
+               " *\n"
+               " */\n"
+               "typedef struct\n"
+               "{\n"
+               "  /* Relevant blocker squares (rays excluding board edge) */\n"
+               "  ftk_board_mask_t mask;\n"
+               "  /* Multiplier mapping relevant blockers to a unique table index */\n"
+               "  ftk_board_mask_t magic;\n"
+               "  /* Offset of this square's attack sets in the attack table */\n"
+               "  uint_fast32_t    offset;\n"
+               "  /* Shift to reduce magic product to index size */\n"
+               "  uint_fast8_t     shift;\n"
+               "} ftk_magic_s;\n\n");
+
+  ftk_gen_print_mask_array(out, "ftk_board_mask_t", "ftk_knight_attack_table", knight, FTK_GEN_BOARD_SIZE);
+  ftk_gen_print_mask_array(out, "ftk_board_mask_t", "ftk_king_attack_table", king, FTK_GEN_BOARD_SIZE);
+  ftk_gen_print_mask_array_2d(out, "ftk_board_mask_t", "ftk_pawn_attack_table", pawn, 2);
+  ftk_gen_print_mask_array_2d(out, "ftk_board_mask_t", "ftk_between_table", between, FTK_GEN_BOARD_SIZE);
+  ftk_gen_print_mask_array_2d(out, "ftk_board_mask_t", "ftk_line_table", line, FTK_GEN_BOARD_SIZE);
+
+  result |= ftk_gen_magic(out, "rook",   ftk_gen_rook_magic_numbers,   false);
+  result |= ftk_gen_magic(out, "bishop", ftk_gen_bishop_magic_numbers, true);
+
+  fprintf(out, "#endif //_FAREWELL_TO_KING_TABLES_H_\n");
+
+  if(0 != ftk_gen_close(out, temp_path, argv[1], result))
+  {
+    return 1;
+  }
+
+  /* Zobrist keys in their own header, hashing does not pull in the attack tables */
+  out = ftk_gen_open(argv[2], temp_path, sizeof(temp_path));
+  if(NULL == out)
+  {
+    return 1;
+  }
+
+  fprintf(out, "/*\n"
+               " farewell_to_king_zobrist.h\n"
+               " Farewell To King - Chess Library\n"
+               "\n"
+               " Generated by farewell_to_king_table_gen.c at build time, do not edit.\n"
+               "*/\n\n"
+               "#ifndef _FAREWELL_TO_KING_ZOBRIST_H_\n"
+               "#define _FAREWELL_TO_KING_ZOBRIST_H_\n"
+               "#include \"farewell_to_king_types.h\"\n\n");
+
+  ftk_gen_print_mask_array_2d(out, "ftk_hash_t", "ftk_zobrist_piece_table", zobrist_piece, 16);
+  ftk_gen_print_mask_array(out, "ftk_hash_t", "ftk_zobrist_castle_table", zobrist_castle, 16);
+  ftk_gen_print_mask_array(out, "ftk_hash_t", "ftk_zobrist_ep_table", zobrist_ep, 8);
+  ftk_gen_print_mask_array(out, "ftk_hash_t", "ftk_zobrist_turn_table", zobrist_turn, 4);
+
+  fprintf(out, "#endif //_FAREWELL_TO_KING_ZOBRIST_H_\n");
+
+  return ftk_gen_close(out, temp_path, argv[2], 0);
+}